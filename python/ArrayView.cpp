@@ -0,0 +1,62 @@
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <util/exceptions.h>
+#include "ArrayView.h"
+
+namespace surfrec {
+
+ArrayView::ArrayView(PyObject* object) {
+
+	if (PyObject_GetBuffer(object, &_buffer, PyBUF_STRIDES | PyBUF_FORMAT) != 0) {
+
+		PyErr_Clear();
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"expected an array (an object supporting the buffer protocol)");
+	}
+
+	std::string format(_buffer.format ? _buffer.format : "B");
+
+	// native byte order prefixes are accepted, explicit little or big endian
+	// ones only if they match the byte order of this machine, everything else
+	// would need swapping
+	const std::uint16_t one = 1;
+	const bool little_endian = (*reinterpret_cast<const unsigned char*>(&one) == 1);
+
+	if (!format.empty() && (
+			format[0] == '@' ||
+			format[0] == '=' ||
+			(format[0] == '<' && little_endian) ||
+			((format[0] == '>' || format[0] == '!') && !little_endian)))
+		format = format.substr(1);
+
+	bool supported = (format.size() == 1);
+
+	if (supported) {
+
+		if (std::strchr("fd", format[0]))
+			_kind = Float;
+		else if (std::strchr("bhilq", format[0]))
+			_kind = SignedInteger;
+		else if (std::strchr("BHILQ", format[0]))
+			_kind = UnsignedInteger;
+		else
+			supported = false;
+	}
+
+	if (!supported) {
+
+		PyBuffer_Release(&_buffer);
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"unsupported array type '" << format << "', expected a numeric type in native byte order");
+	}
+}
+
+ArrayView::~ArrayView() {
+
+	PyBuffer_Release(&_buffer);
+}
+
+} // namespace surfrec
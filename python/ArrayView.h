@@ -0,0 +1,147 @@
+#ifndef PYMAXFLOW_PYTHON_ARRAY_VIEW_H__
+#define PYMAXFLOW_PYTHON_ARRAY_VIEW_H__
+
+#include <Python.h>
+#include <cstddef>
+
+namespace surfrec {
+
+/**
+ * Read-only access to the memory of a python object that supports the buffer
+ * protocol (like NumPy arrays), without copying it. The buffer is released
+ * when the view is destructed.
+ */
+class ArrayView {
+
+public:
+
+	enum ScalarKind {
+
+		Float,
+		SignedInteger,
+		UnsignedInteger
+	};
+
+	/**
+	 * Get a strided view on the buffer of the given object. Throws a
+	 * UsageError if the object does not provide a buffer in native byte
+	 * order of a supported scalar type.
+	 */
+	ArrayView(PyObject* object);
+
+	~ArrayView();
+
+	int ndim() const { return _buffer.ndim; }
+
+	std::size_t shape(int axis) const { return _buffer.shape[axis]; }
+
+	/**
+	 * The stride along the given axis in bytes.
+	 */
+	std::ptrdiff_t stride(int axis) const { return _buffer.strides[axis]; }
+
+	const char* data() const { return static_cast<const char*>(_buffer.buf); }
+
+	ScalarKind kind() const { return _kind; }
+
+	std::size_t itemsize() const { return _buffer.itemsize; }
+
+	/**
+	 * Test whether the scalar type of the array is T.
+	 */
+	template <typename T>
+	bool is() const;
+
+	/**
+	 * Read the element at the given index of a 2D array, converted to T.
+	 */
+	template <typename T>
+	T get(std::size_t i, std::size_t j) const;
+
+	/**
+	 * Read the element at the given index of a 1D array, converted to T.
+	 */
+	template <typename T>
+	T get(std::size_t i) const;
+
+private:
+
+	template <typename T>
+	T convert(const char* item) const;
+
+	// non-copyable, the buffer is released only once
+	ArrayView(const ArrayView&);
+	ArrayView& operator=(const ArrayView&);
+
+	Py_buffer _buffer;
+
+	ScalarKind _kind;
+};
+
+template <typename T>
+bool
+ArrayView::is() const {
+
+	return false;
+}
+
+template <>
+inline bool
+ArrayView::is<float>() const {
+
+	return _kind == Float && _buffer.itemsize == sizeof(float);
+}
+
+template <>
+inline bool
+ArrayView::is<double>() const {
+
+	return _kind == Float && _buffer.itemsize == sizeof(double);
+}
+
+template <typename T>
+T
+ArrayView::get(std::size_t i, std::size_t j) const {
+
+	return convert<T>(data() + i*stride(0) + j*stride(1));
+}
+
+template <typename T>
+T
+ArrayView::get(std::size_t i) const {
+
+	return convert<T>(data() + i*stride(0));
+}
+
+template <typename T>
+T
+ArrayView::convert(const char* item) const {
+
+	switch (_kind) {
+
+		case Float:
+			if (_buffer.itemsize == sizeof(float))
+				return static_cast<T>(*reinterpret_cast<const float*>(item));
+			return static_cast<T>(*reinterpret_cast<const double*>(item));
+
+		case SignedInteger:
+			switch (_buffer.itemsize) {
+				case 1: return static_cast<T>(*reinterpret_cast<const signed char*>(item));
+				case 2: return static_cast<T>(*reinterpret_cast<const short*>(item));
+				case 4: return static_cast<T>(*reinterpret_cast<const int*>(item));
+				default: return static_cast<T>(*reinterpret_cast<const long long*>(item));
+			}
+
+		default:
+			switch (_buffer.itemsize) {
+				case 1: return static_cast<T>(*reinterpret_cast<const unsigned char*>(item));
+				case 2: return static_cast<T>(*reinterpret_cast<const unsigned short*>(item));
+				case 4: return static_cast<T>(*reinterpret_cast<const unsigned int*>(item));
+				default: return static_cast<T>(*reinterpret_cast<const unsigned long long*>(item));
+			}
+	}
+}
+
+} // namespace surfrec
+
+#endif // PYMAXFLOW_PYTHON_ARRAY_VIEW_H__
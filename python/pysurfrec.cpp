@@ -1,9 +1,14 @@
+#include <memory>
 #include <boost/python.hpp>
 #include <boost/python/exception_translator.hpp>
 #include <boost/python/suite/indexing/vector_indexing_suite.hpp>
 
 #include <util/exceptions.h>
 #include <surfrec/IlpSolver.h>
+#include <surfrec/GridSurfaceSolver.h>
+#include <surfrec/MultiResolutionSolver.h>
+#include <surfrec/MultiSurfaceSolver.h>
+#include "ArrayView.h"
 #include "logging.h"
 
 template <typename Map, typename K, typename V>
@@ -30,6 +35,228 @@ void translateException(const Exception& e) {
 		PyErr_SetString(PyExc_RuntimeError, e.what());
 }
 
+/**
+ * Converts python sequences (lists, tuples) into std::vectors.
+ */
+template <typename T>
+struct VectorFromSequence {
+
+	VectorFromSequence() {
+
+		boost::python::converter::registry::push_back(
+				&convertible,
+				&construct,
+				boost::python::type_id<std::vector<T>>());
+	}
+
+	static void* convertible(PyObject* obj) {
+
+		return PySequence_Check(obj) ? obj : 0;
+	}
+
+	static void construct(PyObject* obj, boost::python::converter::rvalue_from_python_stage1_data* data) {
+
+		void* storage = ((boost::python::converter::rvalue_from_python_storage<std::vector<T>>*)data)->storage.bytes;
+		std::vector<T>* v = new (storage) std::vector<T>();
+
+		Py_ssize_t size = PySequence_Size(obj);
+		v->reserve(size);
+		for (Py_ssize_t i = 0; i < size; i++) {
+
+			boost::python::object item(boost::python::handle<>(PySequence_GetItem(obj, i)));
+
+			// NumPy scalars (e.g., from the arrays returned by levels()) are
+			// not python ints
+			if (!boost::python::extract<T>(item).check())
+				item = boost::python::object(boost::python::handle<>(PyNumber_Long(item.ptr())));
+
+			v->push_back(boost::python::extract<T>(item));
+		}
+
+		data->convertible = storage;
+	}
+};
+
+/**
+ * Set the level costs of all nodes of an IlpSolver from a float32 or float64
+ * array, without per-element python calls. The array is either 2D (nodes x
+ * levels for column_axis 1) or a 3D volume, in which case the nodes are the
+ * positions along the two other axes in C order.
+ */
+template <typename T>
+void setAllLevelCosts(IlpSolver& solver, const ArrayView& costs, int column_axis) {
+
+	const T* data = reinterpret_cast<const T*>(costs.data());
+
+	if (costs.ndim() == 2) {
+
+		int node_axis = 1 - column_axis;
+		solver.set_level_costs(0, costs.shape(node_axis), data, costs.stride(node_axis), costs.stride(column_axis));
+
+	} else {
+
+		// the two axes enumerating the nodes, the last one varies fastest
+		int outer_axis = (column_axis == 0 ? 1 : 0);
+		int inner_axis = (column_axis == 2 ? 1 : 2);
+
+		for (std::size_t i = 0; i < costs.shape(outer_axis); i++)
+			solver.set_level_costs(
+					i*costs.shape(inner_axis),
+					costs.shape(inner_axis),
+					reinterpret_cast<const T*>(costs.data() + i*costs.stride(outer_axis)),
+					costs.stride(inner_axis),
+					costs.stride(column_axis));
+	}
+}
+
+void setAllLevelCosts(IlpSolver& solver, boost::python::object array, int column_axis) {
+
+	ArrayView costs(array.ptr());
+
+	if (costs.ndim() != 2 && costs.ndim() != 3)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"level costs have to be given as a 2D or 3D array, got " << costs.ndim() << " dimensions");
+
+	if (column_axis < 0)
+		column_axis += costs.ndim();
+
+	if (column_axis < 0 || column_axis >= costs.ndim())
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"invalid column axis " << column_axis << " for an array with " << costs.ndim() << " dimensions");
+
+	std::size_t num_nodes = 1;
+	for (int d = 0; d < costs.ndim(); d++)
+		if (d != column_axis)
+			num_nodes *= costs.shape(d);
+
+	if (num_nodes != solver.num_nodes() || costs.shape(column_axis) != static_cast<std::size_t>(solver.num_levels()))
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"expected level costs for " << solver.num_nodes() << " nodes with " <<
+				solver.num_levels() << " levels, got " << num_nodes << " nodes with " <<
+				costs.shape(column_axis) << " levels");
+
+	if (costs.is<float>())
+		setAllLevelCosts<float>(solver, costs, column_axis);
+	else if (costs.is<double>())
+		setAllLevelCosts<double>(solver, costs, column_axis);
+	else
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"level costs have to be float32 or float64");
+}
+
+/**
+ * Add edges to an IlpSolver from an (E x 2) integer array of node pairs and an
+ * optional array of E max gradients, without per-edge python calls. All
+ * edges are checked before the first one is added, such that the solver is
+ * left unchanged if an exception is thrown.
+ */
+void addEdges(IlpSolver& solver, boost::python::object edges, boost::python::object max_gradients) {
+
+	ArrayView uv(edges.ptr());
+
+	if (uv.ndim() != 2 || uv.shape(1) != 2 || uv.kind() == ArrayView::Float)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"edges have to be given as an integer array of shape (num_edges, 2)");
+
+	const std::size_t num_edges = uv.shape(0);
+
+	std::unique_ptr<ArrayView> gradients;
+	if (!max_gradients.is_none()) {
+
+		gradients.reset(new ArrayView(max_gradients.ptr()));
+
+		if (gradients->ndim() != 1 || gradients->shape(0) != num_edges || gradients->kind() == ArrayView::Float)
+			UTIL_THROW_EXCEPTION(
+					UsageError,
+					"max gradients have to be given as an integer array with one value per edge");
+	}
+
+	for (std::size_t i = 0; i < num_edges; i++) {
+
+		// negative ids wrap around and are caught here, too
+		IlpSolver::NodeId u = uv.get<IlpSolver::NodeId>(i, 0);
+		IlpSolver::NodeId v = uv.get<IlpSolver::NodeId>(i, 1);
+
+		if (u >= solver.num_nodes() || v >= solver.num_nodes())
+			UTIL_THROW_EXCEPTION(
+					UsageError,
+					"can not add edge " << i << " (" << u << ", " << v << "), there are only " << solver.num_nodes() << " nodes");
+
+		if (gradients && gradients->get<int>(i) < 0)
+			UTIL_THROW_EXCEPTION(
+					UsageError,
+					"the max gradient of edge " << i << " (" << u << ", " << v << ") is negative");
+	}
+
+	solver.reserve_edges(solver.num_edges() + num_edges);
+
+	for (std::size_t i = 0; i < num_edges; i++) {
+
+		IlpSolver::NodeId u = uv.get<IlpSolver::NodeId>(i, 0);
+		IlpSolver::NodeId v = uv.get<IlpSolver::NodeId>(i, 1);
+
+		if (gradients)
+			solver.add_edge(u, v, gradients->get<int>(i));
+		else
+			solver.add_edge(u, v);
+	}
+}
+
+/**
+ * Add the edges of a regular lattice to an IlpSolver, with an optional penalty
+ * on all of them.
+ */
+void addGridEdges(
+		IlpSolver& solver,
+		const std::vector<std::size_t>& shape,
+		int connectivity,
+		const std::vector<int>& max_gradients,
+		const std::vector<bool>& wrap_around,
+		boost::python::object penalty) {
+
+	if (penalty.is_none())
+		solver.add_grid_edges(shape, connectivity, max_gradients, wrap_around);
+	else
+		solver.add_grid_edges(shape, connectivity, max_gradients, wrap_around, boost::python::extract<std::size_t>(penalty));
+}
+
+/**
+ * Get the levels of the last solution of an IlpSolver as an int32 NumPy
+ * array. The array owns a copy of the levels (a single memcpy), such that it
+ * stays valid when the solver finds new levels, gets more nodes, or is
+ * deleted.
+ */
+boost::python::object levels(const IlpSolver& solver) {
+
+	const std::vector<int>& levels = solver.levels();
+
+	if (levels.empty() || levels.size() != solver.num_nodes())
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"no levels found, call min_surface() first");
+
+	Py_buffer buffer;
+	PyBuffer_FillInfo(
+			&buffer,
+			0,
+			const_cast<int*>(levels.data()),
+			levels.size()*sizeof(int),
+			1 /* read-only */,
+			PyBUF_SIMPLE);
+
+	// the memory view is only used to copy the levels, it does not outlive
+	// this call
+	boost::python::object memory(boost::python::handle<>(PyMemoryView_FromBuffer(&buffer)));
+	boost::python::object numpy = boost::python::import("numpy");
+
+	return numpy.attr("frombuffer")(memory, "int32").attr("copy")();
+}
+
 /**
  * Defines all the python classes in the module libpymaxflow. Here we decide 
  * which functions and data members we wish to expose.
@@ -50,6 +277,11 @@ BOOST_PYTHON_MODULE(surfrec) {
 	boost::python::def("getLogLevel", getLogLevel);
 			;
 
+	// python sequences to std::vector
+	VectorFromSequence<std::size_t>();
+	VectorFromSequence<int>();
+	VectorFromSequence<bool>();
+
 	// std::vector<double>
 	boost::python::class_<std::vector<double>>("ColumnCosts")
 			.def(boost::python::init<>())
@@ -57,27 +289,125 @@ BOOST_PYTHON_MODULE(surfrec) {
 			.def(boost::python::vector_indexing_suite<std::vector<double>>())
 			;
 
+	// IlpSolver::Engine
+	boost::python::enum_<IlpSolver::Engine>("IlpSolverEngine")
+			.value("Ilp", IlpSolver::Ilp)
+			.value("MinCut", IlpSolver::MinCut)
+			.value("DynamicProgramming", IlpSolver::DynamicProgramming)
+			;
+
+	// IlpSolver::Formulation
+	boost::python::enum_<IlpSolver::Formulation>("IlpSolverFormulation")
+			.value("Indicators", IlpSolver::Indicators)
+			.value("Heights", IlpSolver::Heights)
+			;
+
 	// IlpSolver::Parameters
 	boost::python::class_<IlpSolver::Parameters>("IlpSolverParameters")
+			.def_readwrite("engine", &IlpSolver::Parameters::engine)
+			.def_readwrite("formulation", &IlpSolver::Parameters::formulation)
 			.def_readwrite("enforce_zero_minimum", &IlpSolver::Parameters::enforce_zero_minimum)
 			.def_readwrite("num_neighbors", &IlpSolver::Parameters::num_neighbors)
 			.def_readwrite("num_threads", &IlpSolver::Parameters::num_threads)
 			.def_readwrite("solve_relaxed_problem", &IlpSolver::Parameters::solve_relaxed_problem)
+			.def_readwrite("detect_integral_lp", &IlpSolver::Parameters::detect_integral_lp)
+			.def_readwrite("lazy_constraints", &IlpSolver::Parameters::lazy_constraints)
+			.def_readwrite("presolve", &IlpSolver::Parameters::presolve)
+			.def_readwrite("contract_zero_gradient_edges", &IlpSolver::Parameters::contract_zero_gradient_edges)
 			.def_readwrite("verbose", &IlpSolver::Parameters::verbose)
 			;
 
+	// IlpSolver::Statistics
+	boost::python::class_<IlpSolver::Statistics>("IlpSolverStatistics")
+			.def_readonly("engine", &IlpSolver::Statistics::engine)
+			.def_readonly("num_variables", &IlpSolver::Statistics::num_variables)
+			.def_readonly("num_constraints", &IlpSolver::Statistics::num_constraints)
+			.def_readonly("solved_as_lp", &IlpSolver::Statistics::solved_as_lp)
+			.def_readonly("lp_fallback", &IlpSolver::Statistics::lp_fallback)
+			.def_readonly("num_lazy_rounds", &IlpSolver::Statistics::num_lazy_rounds)
+			.def_readonly("num_removed_variables", &IlpSolver::Statistics::num_removed_variables)
+			.def_readonly("num_removed_constraints", &IlpSolver::Statistics::num_removed_constraints)
+			.def_readonly("num_contracted_nodes", &IlpSolver::Statistics::num_contracted_nodes)
+			;
+
 	// IlpSolver
 	boost::python::class_<IlpSolver, boost::noncopyable>("IlpSolver", boost::python::init<std::size_t, std::size_t, int, int>())
+			.def(boost::python::init<std::size_t, std::size_t, int, int, bool>())
 			.def("add_nodes", &IlpSolver::add_nodes)
 			.def("add_edge", static_cast<void(IlpSolver::*)(IlpSolver::NodeId, IlpSolver::NodeId, int)>(&IlpSolver::add_edge))
 			.def("add_edge", static_cast<void(IlpSolver::*)(IlpSolver::NodeId, IlpSolver::NodeId)>(&IlpSolver::add_edge))
-			.def("set_level_costs", &IlpSolver::set_level_costs)
+			.def("add_edge", static_cast<void(IlpSolver::*)(IlpSolver::NodeId, IlpSolver::NodeId, int, std::size_t)>(&IlpSolver::add_edge))
+			.def("add_edges", &addEdges, (boost::python::arg("edges"), boost::python::arg("max_gradients") = boost::python::object()))
+			.def("add_grid_edges", &addGridEdges,
+					(boost::python::arg("shape"), boost::python::arg("connectivity"), boost::python::arg("max_gradients"), boost::python::arg("wrap_around") = boost::python::list(), boost::python::arg("penalty") = boost::python::object()))
+			.def("add_penalty", &IlpSolver::add_penalty)
+			.def("add_separation", &IlpSolver::add_separation)
+			.def("num_nodes", &IlpSolver::num_nodes)
+			.def("num_edges", &IlpSolver::num_edges)
+			.def("num_separations", &IlpSolver::num_separations)
+			.def("num_levels", &IlpSolver::num_levels)
+			.def("set_level_costs", static_cast<void(IlpSolver::*)(IlpSolver::NodeId, const std::vector<double>&)>(&IlpSolver::set_level_costs))
+			.def("set_all_level_costs", static_cast<void(*)(IlpSolver&, boost::python::object, int)>(&setAllLevelCosts),
+					(boost::python::arg("costs"), boost::python::arg("column_axis") = -1))
+			.def("set_level_range", &IlpSolver::set_level_range)
+			.def("has_feasible_surface", &IlpSolver::has_feasible_surface)
 			.def("min_surface", static_cast<double(IlpSolver::*)()>(&IlpSolver::min_surface))
 			.def("min_surface", static_cast<double(IlpSolver::*)(const IlpSolver::Parameters&)>(&IlpSolver::min_surface))
+			.def("min_surface", static_cast<double(IlpSolver::*)(const IlpSolver::Parameters&, const std::vector<int>&)>(&IlpSolver::min_surface))
+			.def("update_level_costs", &IlpSolver::update_level_costs)
+			.def("resolve", &IlpSolver::resolve)
 			.def("level", &IlpSolver::level)
+			.def("levels", &levels)
+			.def("statistics", &IlpSolver::statistics, boost::python::return_value_policy<boost::python::copy_const_reference>())
 			.def("dump_ilp", &IlpSolver::dump_ilp)
 			;
 
+	// GridSurfaceSolver
+	boost::python::class_<GridSurfaceSolver, boost::noncopyable>("GridSurfaceSolver", boost::python::init<const std::vector<std::size_t>&, int, int, const std::vector<int>&>())
+			.def("num_nodes", &GridSurfaceSolver::num_nodes)
+			.def("set_level_costs", &GridSurfaceSolver::set_level_costs)
+			.def("min_surface", &GridSurfaceSolver::min_surface)
+			.def("level", &GridSurfaceSolver::level)
+			.def("statistics", &GridSurfaceSolver::statistics, boost::python::return_value_policy<boost::python::copy_const_reference>())
+			;
+
+	// MultiResolutionSolver::Parameters
+	boost::python::class_<MultiResolutionSolver::Parameters>("MultiResolutionSolverParameters")
+			.def_readwrite("num_scales", &MultiResolutionSolver::Parameters::num_scales)
+			.def_readwrite("lateral_factor", &MultiResolutionSolver::Parameters::lateral_factor)
+			.def_readwrite("level_factor", &MultiResolutionSolver::Parameters::level_factor)
+			.def_readwrite("band", &MultiResolutionSolver::Parameters::band)
+			.def_readwrite("solver_parameters", &MultiResolutionSolver::Parameters::solver_parameters)
+			;
+
+	// MultiResolutionSolver
+	boost::python::class_<MultiResolutionSolver, boost::noncopyable>("MultiResolutionSolver", boost::python::init<const std::vector<std::size_t>&, int, int, const std::vector<int>&>())
+			.def("num_nodes", &MultiResolutionSolver::num_nodes)
+			.def("set_level_costs", &MultiResolutionSolver::set_level_costs)
+			.def("min_surface", static_cast<double(MultiResolutionSolver::*)()>(&MultiResolutionSolver::min_surface))
+			.def("min_surface", static_cast<double(MultiResolutionSolver::*)(const MultiResolutionSolver::Parameters&)>(&MultiResolutionSolver::min_surface))
+			.def("level", &MultiResolutionSolver::level)
+			.def("statistics", &MultiResolutionSolver::statistics, boost::python::return_value_policy<boost::python::copy_const_reference>())
+			;
+
+	// MultiSurfaceSolver
+	boost::python::class_<MultiSurfaceSolver, boost::noncopyable>("MultiSurfaceSolver", boost::python::init<std::size_t, std::size_t, int, int, int>())
+			.def("add_nodes", &MultiSurfaceSolver::add_nodes)
+			.def("add_edge", static_cast<void(MultiSurfaceSolver::*)(MultiSurfaceSolver::NodeId, MultiSurfaceSolver::NodeId, int)>(&MultiSurfaceSolver::add_edge))
+			.def("add_edge", static_cast<void(MultiSurfaceSolver::*)(MultiSurfaceSolver::NodeId, MultiSurfaceSolver::NodeId)>(&MultiSurfaceSolver::add_edge))
+			.def("add_grid_edges", &MultiSurfaceSolver::add_grid_edges,
+					(boost::python::arg("shape"), boost::python::arg("connectivity"), boost::python::arg("max_gradients"), boost::python::arg("wrap_around") = boost::python::list()))
+			.def("num_nodes", &MultiSurfaceSolver::num_nodes)
+			.def("num_surfaces", &MultiSurfaceSolver::num_surfaces)
+			.def("num_levels", &MultiSurfaceSolver::num_levels)
+			.def("set_level_costs", &MultiSurfaceSolver::set_level_costs)
+			.def("set_separation", &MultiSurfaceSolver::set_separation)
+			.def("min_surface", static_cast<double(MultiSurfaceSolver::*)()>(&MultiSurfaceSolver::min_surface))
+			.def("min_surface", static_cast<double(MultiSurfaceSolver::*)(const IlpSolver::Parameters&)>(&MultiSurfaceSolver::min_surface))
+			.def("level", &MultiSurfaceSolver::level)
+			.def("statistics", &MultiSurfaceSolver::statistics, boost::python::return_value_policy<boost::python::copy_const_reference>())
+			;
+
 }
 
 } // namespace surfrec
@@ -2,6 +2,7 @@
 
 #ifdef HAVE_CPLEX
 
+#include <limits>
 #include <string>
 #include <vector>
 
@@ -46,13 +47,40 @@ CplexBackend::initialize(
         VariableType                                defaultVariableType,
         const std::map<unsigned int, VariableType>& specialVariableTypes) {
 
+    initialize(numVariables, defaultVariableType, specialVariableTypes, std::vector<double>(), std::vector<double>());
+}
+
+void
+CplexBackend::initialize(
+        unsigned int                                numVariables,
+        VariableType                                defaultVariableType,
+        const std::map<unsigned int, VariableType>& specialVariableTypes,
+        const std::vector<double>&                  lowerBounds,
+        const std::vector<double>&                  upperBounds) {
+
+    checkBounds(numVariables, lowerBounds, upperBounds);
+
     _numVariables = numVariables;
 
     // delete previous variables
     x_.clear();
 
     // add new variables to the model
-    if (defaultVariableType == Binary) {
+    if (!lowerBounds.empty() || !upperBounds.empty()) {
+        LOG_USER(cplexlog) << "creating " << _numVariables << " bounded variables" << std::endl;
+        double defaultLb = (defaultVariableType == Binary ? 0 : -IloInfinity);
+        double defaultUb = (defaultVariableType == Binary ? 1 :  IloInfinity);
+        IloNumArray lbs(env_, _numVariables);
+        IloNumArray ubs(env_, _numVariables);
+        for (unsigned int i = 0; i < _numVariables; i++) {
+            lbs[i] = (lowerBounds.empty() ? defaultLb : lowerBounds[i]);
+            ubs[i] = (upperBounds.empty() ? defaultUb : upperBounds[i]);
+        }
+        IloNumVar::Type type = (defaultVariableType == Binary ? ILOBOOL : (defaultVariableType == Integer ? ILOINT : ILOFLOAT));
+        x_.add(IloNumVarArray(env_, lbs, ubs, type));
+        lbs.end();
+        ubs.end();
+    } else if (defaultVariableType == Binary) {
         LOG_USER(cplexlog) << "creating " << _numVariables << " binary variables" << std::endl;
         x_.add(IloNumVarArray(env_, _numVariables, 0, 1, ILOBOOL));
     } else if (defaultVariableType == Continuous) {
@@ -136,6 +164,39 @@ CplexBackend::setObjective(const QuadraticObjective& objective) {
     }
 }
 
+void
+CplexBackend::setObjectiveCoefficients(
+        const std::vector<unsigned int>& varNums,
+        const std::vector<double>&       coefs) {
+
+    try {
+
+        // the objective stays part of the model, changes to it are picked up
+        // by the next solve
+        LOG_DEBUG(cplexlog) << "changing " << varNums.size() << " linear coefficients" << std::endl;
+
+        for (size_t i = 0; i < varNums.size(); i++)
+            obj_.setLinearCoef(x_[varNums[i]], coefs[i]);
+
+    } catch (IloCplex::Exception e) {
+
+        LOG_ERROR(cplexlog) << "CPLEX error: " << e.getMessage() << std::endl;
+    }
+}
+
+void
+CplexBackend::setInitialSolution(const Solution& solution) {
+
+    checkInitialSolution(_numVariables, solution);
+
+    LOG_DEBUG(cplexlog) << "setting initial solution" << std::endl;
+
+    // the IloCplex instance is only created in solve()
+    _initialSolution.resize(_numVariables);
+    for (unsigned int i = 0; i < _numVariables; i++)
+        _initialSolution[i] = solution[i];
+}
+
 void
 CplexBackend::setConstraints(const LinearConstraints& constraints) {
 
@@ -147,18 +208,19 @@ CplexBackend::setConstraints(const LinearConstraints& constraints) {
     // allocate memory for new constraints
     _constraints.reserve(constraints.size());
 
-    try {
-        LOG_USER(cplexlog) << "setting " << constraints.size() << " constraints" << std::endl;
+    LOG_USER(cplexlog) << "setting " << constraints.size() << " constraints" << std::endl;
 
-        IloExtractableArray cplex_constraints(env_);
-        for (LinearConstraints::const_iterator constraint = constraints.begin(); constraint != constraints.end(); constraint++) {
-            IloRange linearConstraint = createConstraint(*constraint);
-            _constraints.push_back(linearConstraint);
-            cplex_constraints.add(linearConstraint);
-        }
+    addConstraintsInBatches(constraints);
+}
+
+void
+CplexBackend::addConstraint(const LinearConstraint& constraint) {
+
+    try {
+        LOG_ALL(cplexlog) << "adding a constraint" << std::endl;
 
-        // add all constraints as batch to the model
-        model_.add(cplex_constraints);
+        // add to the model
+        _constraints.push_back(model_.add(createConstraint(constraint)));
 
     } catch (IloCplex::Exception e) {
 
@@ -167,13 +229,42 @@ CplexBackend::setConstraints(const LinearConstraints& constraints) {
 }
 
 void
-CplexBackend::addConstraint(const LinearConstraint& constraint) {
+CplexBackend::addConstraints(
+        std::size_t         numConstraints,
+        const std::size_t*  rowOffsets,
+        const unsigned int* columns,
+        const double*       values,
+        const Relation*     relations,
+        const double*       rhs) {
 
     try {
-        LOG_ALL(cplexlog) << "adding a constraint" << std::endl;
+        LOG_ALL(cplexlog) << "adding " << numConstraints << " constraints" << std::endl;
 
-        // add to the model
-        _constraints.push_back(model_.add(createConstraint(constraint)));
+        IloRangeArray ranges(env_, numConstraints);
+
+        for (std::size_t i = 0; i < numConstraints; i++) {
+
+            IloNum lb = (relations[i] == LessEqual    ? -IloInfinity : rhs[i]);
+            IloNum ub = (relations[i] == GreaterEqual ?  IloInfinity : rhs[i]);
+
+            ranges[i] = IloRange(env_, lb, ub);
+
+            IloNumVarArray vars(env_);
+            IloNumArray    coefs(env_);
+            for (std::size_t k = rowOffsets[i]; k < rowOffsets[i+1]; k++) {
+                vars.add(x_[columns[k]]);
+                coefs.add(values[k]);
+            }
+            ranges[i].setLinearCoefs(vars, coefs);
+
+            vars.end();
+            coefs.end();
+
+            _constraints.push_back(ranges[i]);
+        }
+
+        // add all constraints as one batch to the model
+        model_.add(ranges);
 
     } catch (IloCplex::Exception e) {
 
@@ -213,7 +304,7 @@ CplexBackend::createConstraint(const LinearConstraint& constraint) {
 }
 
 bool
-CplexBackend::solve(Solution& x,/* double& value, */ std::string& msg, const LinearSolverBackend::Parameters& paramter) {
+CplexBackend::solve(Solution& x,/* double& value, */ std::string& msg, const LinearSolverBackend::Parameters& parameter) {
 
     try {
         cplex_ = IloCplex(model_);
@@ -228,6 +319,17 @@ CplexBackend::solve(Solution& x,/* double& value, */ std::string& msg, const Lin
 
         setNumThreads(parameter.numThreads);
 
+        if (!_initialSolution.empty()) {
+
+            IloNumArray start(env_, _numVariables);
+            for (unsigned int i = 0; i < _numVariables; i++)
+                start[i] = _initialSolution[i];
+            cplex_.addMIPStart(x_, start);
+            start.end();
+
+            _initialSolution.clear();
+        }
+
         if(!cplex_.solve()) {
            LOG_USER(cplexlog) << "failed to optimize. " << cplex_.getStatus() << std::endl;
            msg = "Optimal solution *NOT* found";
@@ -245,8 +347,6 @@ CplexBackend::solve(Solution& x,/* double& value, */ std::string& msg, const Lin
         // get current value of the objective
         const double value = cplex_.getObjValue();
         x.setValue(value);
-        model_.remove(obj_);
-        //cplex_.clearModel();
 
     } catch (IloCplex::Exception& e) {
 
@@ -265,7 +365,6 @@ CplexBackend::setMIPGap(double gap) {
      cplex_.setParam(IloCplex::EpGap, gap);
 }
 
-A
 void
 CplexBackend::setMIPFocus(unsigned int focus) {
     /*
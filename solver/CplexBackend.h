@@ -52,14 +52,35 @@ public:
             VariableType                                defaultVariableType,
             const std::map<unsigned int, VariableType>& specialVariableTypes);
 
+    void initialize(
+            unsigned int                                numVariables,
+            VariableType                                defaultVariableType,
+            const std::map<unsigned int, VariableType>& specialVariableTypes,
+            const std::vector<double>&                  lowerBounds,
+            const std::vector<double>&                  upperBounds);
+
     void setObjective(const LinearObjective& objective);
 
     void setObjective(const QuadraticObjective& objective);
 
+    void setObjectiveCoefficients(
+            const std::vector<unsigned int>& varNums,
+            const std::vector<double>&       coefs);
+
+    void setInitialSolution(const Solution& solution);
+
     void setConstraints(const LinearConstraints& constraints);
 
     void addConstraint(const LinearConstraint& constraint);
 
+    void addConstraints(
+            std::size_t         numConstraints,
+            const std::size_t*  rowOffsets,
+            const unsigned int* columns,
+            const double*       values,
+            const Relation*     relations,
+            const double*       rhs);
+
     bool solve(Solution& solution,/* double& value, */ std::string& message, const LinearSolverBackend::Parameters& parameters = LinearSolverBackend::Parameters());
 
 private:
@@ -94,8 +115,6 @@ private:
     // rows in C
     unsigned int _numIneqConstraints;
 
-    Parameter _parameter;
-
     // the verbosity of the output
     int _verbosity;
 
@@ -109,6 +128,9 @@ private:
     IloRangeArray c_;
     IloObjective obj_;
     IloNumArray sol_;
+
+    // the initial solution to pass to the next solve()
+    std::vector<double> _initialSolution;
     IloCplex cplex_;
     double constValue_;
 
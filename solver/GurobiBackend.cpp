@@ -76,6 +76,19 @@ GurobiBackend::initialize(
 		VariableType                                defaultVariableType,
 		const std::map<unsigned int, VariableType>& specialVariableTypes) {
 
+	initialize(numVariables, defaultVariableType, specialVariableTypes, std::vector<double>(), std::vector<double>());
+}
+
+void
+GurobiBackend::initialize(
+		unsigned int                                numVariables,
+		VariableType                                defaultVariableType,
+		const std::map<unsigned int, VariableType>& specialVariableTypes,
+		const std::vector<double>&                  lowerBounds,
+		const std::vector<double>&                  upperBounds) {
+
+	checkBounds(numVariables, lowerBounds, upperBounds);
+
 	// create a new model
 
 	if (_model)
@@ -93,7 +106,8 @@ GurobiBackend::initialize(
 
 	_numVariables = numVariables;
 
-	// create arrays of  variable types and infinite lower bounds
+	// create arrays of  variable types and lower bounds (infinite, if not
+	// given)
 	char* vtypes = new char[_numVariables];
 	double* lbs = new double[_numVariables];
 	for (int i = 0; i < _numVariables; i++) {
@@ -104,9 +118,12 @@ GurobiBackend::initialize(
 		char t = (type == Binary ? 'B' : (type == Integer ? 'I' : 'C'));
 
 		vtypes[i] = t;
-		lbs[i] = -GRB_INFINITY;
+		lbs[i] = (lowerBounds.empty() ? -GRB_INFINITY : lowerBounds[i]);
 	}
 
+	// upper bounds are infinite, if not given
+	double* ubs = (upperBounds.empty() ? NULL : const_cast<double*>(upperBounds.data()));
+
 	LOG_DEBUG(gurobilog) << "creating " << _numVariables << " variables" << std::endl;
 
 	GRB_CHECK(GRBaddvars(
@@ -115,7 +132,8 @@ GurobiBackend::initialize(
 			0,                // num non-zeros for constraint matrix (we set it later)
 			NULL, NULL, NULL, // vbeg, vind, vval for constraint matrix
 			NULL,             // obj (we set it later)
-			lbs, NULL,        // lower and upper bound, set to -inf and inf
+			lbs,              // lower bounds
+			ubs,              // upper bounds, inf if NULL
 			vtypes,           // variable types
 			NULL));           // names
 
@@ -180,6 +198,45 @@ GurobiBackend::setObjective(const QuadraticObjective& objective) {
 	GRB_CHECK(GRBupdatemodel(_model));
 }
 
+void
+GurobiBackend::setObjectiveCoefficients(
+		const std::vector<unsigned int>& varNums,
+		const std::vector<double>&       coefs) {
+
+	if (varNums.empty())
+		return;
+
+	std::vector<int> inds(varNums.begin(), varNums.end());
+
+	LOG_DEBUG(gurobilog) << "changing " << inds.size() << " linear coefficients" << std::endl;
+
+	GRB_CHECK(GRBsetdblattrlist(
+			_model,
+			GRB_DBL_ATTR_OBJ,
+			inds.size(),
+			&inds[0],
+			const_cast<double*>(&coefs[0])));
+
+	GRB_CHECK(GRBupdatemodel(_model));
+}
+
+void
+GurobiBackend::setInitialSolution(const Solution& solution) {
+
+	checkInitialSolution(_numVariables, solution);
+
+	LOG_DEBUG(gurobilog) << "setting initial solution" << std::endl;
+
+	GRB_CHECK(GRBsetdblattrarray(
+			_model,
+			GRB_DBL_ATTR_START,
+			0,
+			_numVariables,
+			const_cast<double*>(&solution[0])));
+
+	GRB_CHECK(GRBupdatemodel(_model));
+}
+
 void
 GurobiBackend::setConstraints(const LinearConstraints& constraints) {
 
@@ -197,18 +254,8 @@ GurobiBackend::setConstraints(const LinearConstraints& constraints) {
 
 	LOG_DEBUG(gurobilog) << "setting " << constraints.size() << " constraints" << std::endl;
 
-	_numConstraints = constraints.size();
-	unsigned int j = 0;
-	for (const LinearConstraint& constraint : constraints) {
-
-		if (j > 0)
-			if (j % 1000 == 0)
-				LOG_ALL(gurobilog) << "" << j << " constraints set so far" << std::endl;
-
-		addConstraint(constraint);
-
-		j++;
-	}
+	_numConstraints = 0;
+	addConstraintsInBatches(constraints);
 
 	GRB_CHECK(GRBupdatemodel(_model));
 }
@@ -243,6 +290,53 @@ GurobiBackend::addConstraint(const LinearConstraint& constraint) {
 
 	delete[] inds;
 	delete[] vals;
+
+	_numConstraints++;
+}
+
+void
+GurobiBackend::addConstraints(
+		std::size_t         numConstraints,
+		const std::size_t*  rowOffsets,
+		const unsigned int* columns,
+		const double*       values,
+		const Relation*     relations,
+		const double*       rhs) {
+
+	if (numConstraints == 0)
+		return;
+
+	const std::size_t numNz = rowOffsets[numConstraints] - rowOffsets[0];
+
+	// Gurobi expects int column indices and char senses, the offsets are
+	// rebased to start at zero
+	std::vector<std::size_t> beg(numConstraints);
+	std::vector<int>         inds(columns + rowOffsets[0], columns + rowOffsets[numConstraints]);
+	std::vector<char>        senses(numConstraints);
+
+	for (std::size_t i = 0; i < numConstraints; i++) {
+
+		beg[i] = rowOffsets[i] - rowOffsets[0];
+		senses[i] =
+				(relations[i] == LessEqual ? GRB_LESS_EQUAL :
+						(relations[i] == GreaterEqual ? GRB_GREATER_EQUAL :
+								GRB_EQUAL));
+	}
+
+	LOG_ALL(gurobilog) << "adding " << numConstraints << " constraints with " << numNz << " non-zeros" << std::endl;
+
+	GRB_CHECK(GRBXaddconstrs(
+			_model,
+			numConstraints,
+			numNz,
+			&beg[0],
+			inds.data(),
+			const_cast<double*>(values + rowOffsets[0]),
+			&senses[0],
+			const_cast<double*>(rhs),
+			NULL /* optional names */));
+
+	_numConstraints += numConstraints;
 }
 
 bool
@@ -52,14 +52,35 @@ public:
 			VariableType                                defaultVariableType,
 			const std::map<unsigned int, VariableType>& specialVariableTypes);
 
+	void initialize(
+			unsigned int                                numVariables,
+			VariableType                                defaultVariableType,
+			const std::map<unsigned int, VariableType>& specialVariableTypes,
+			const std::vector<double>&                  lowerBounds,
+			const std::vector<double>&                  upperBounds);
+
 	void setObjective(const LinearObjective& objective);
 
 	void setObjective(const QuadraticObjective& objective);
 
+	void setObjectiveCoefficients(
+			const std::vector<unsigned int>& varNums,
+			const std::vector<double>&       coefs);
+
+	void setInitialSolution(const Solution& solution);
+
 	void setConstraints(const LinearConstraints& constraints);
 
 	void addConstraint(const LinearConstraint& constraint);
 
+	void addConstraints(
+			std::size_t         numConstraints,
+			const std::size_t*  rowOffsets,
+			const unsigned int* columns,
+			const double*       values,
+			const Relation*     relations,
+			const double*       rhs);
+
 	bool solve(Solution& solution, std::string& message, const LinearSolverBackend::Parameters& params = LinearSolverBackend::Parameters());
 
 	// dump the current problem to a file
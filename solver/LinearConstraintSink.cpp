@@ -0,0 +1,77 @@
+#include <algorithm>
+#include <util/exceptions.h>
+#include "LinearConstraintSink.h"
+
+void
+LinearSolverBackendSink::addConstraints(const LinearConstraints& batch) {
+
+	if (batch.size() == 0)
+		return;
+
+	_backend.addConstraints(
+			batch.size(),
+			batch.getRowOffsets().data(),
+			batch.getVarNums().data(),
+			batch.getCoefficients().data(),
+			batch.getRelations().data(),
+			batch.getValues().data());
+}
+
+LinearConstraintFileSink::LinearConstraintFileSink(const std::string& filename) :
+	_out(filename.c_str()) {
+
+	if (!_out)
+		UTIL_THROW_EXCEPTION(
+				IOError,
+				"can not open " << filename << " for writing");
+}
+
+void
+LinearConstraintFileSink::addConstraints(const LinearConstraints& batch) {
+
+	for (auto constraint : batch)
+		_out << constraint << "\n";
+
+	if (!_out)
+		UTIL_THROW_EXCEPTION(
+				IOError,
+				"failed to write constraints");
+}
+
+LinearConstraintStream::LinearConstraintStream(LinearConstraintSink& sink, std::size_t batchSize) :
+	_sink(sink),
+	_batchSize(std::max(batchSize, static_cast<std::size_t>(1))),
+	_numFlushed(0),
+	_batch(_batchSize) {}
+
+LinearConstraints::Builder
+LinearConstraintStream::emplace(Relation relation, double value) {
+
+	// the builder of the previous constraint is invalidated by this call
+	// anyway, so the batch can be passed on before the next one is started
+	if (_batch.size() >= _batchSize)
+		flush();
+
+	return _batch.emplace(relation, value);
+}
+
+void
+LinearConstraintStream::add(const LinearConstraints& constraints) {
+
+	// keep the order of constraints
+	if (_batch.size() > 0)
+		flush();
+
+	_sink.addConstraints(constraints);
+	_numFlushed += constraints.size();
+}
+
+void
+LinearConstraintStream::flush() {
+
+	_sink.addConstraints(_batch);
+	_numFlushed += _batch.size();
+
+	// keeps the memory of the batch for the next one
+	_batch.clear();
+}
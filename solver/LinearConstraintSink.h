@@ -0,0 +1,137 @@
+#ifndef INFERENCE_LINEAR_CONSTRAINT_SINK_H__
+#define INFERENCE_LINEAR_CONSTRAINT_SINK_H__
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+
+#include "LinearConstraints.h"
+#include "LinearSolverBackend.h"
+
+/**
+ * Receives linear constraints in batches, as they are generated. Used to pass
+ * large models to their destination without keeping all constraints in memory
+ * at once.
+ */
+class LinearConstraintSink {
+
+public:
+
+	virtual ~LinearConstraintSink() {}
+
+	/**
+	 * Receive a batch of constraints. The batch is only valid during the call.
+	 */
+	virtual void addConstraints(const LinearConstraints& batch) = 0;
+};
+
+/**
+ * A sink that adds all constraints to a LinearSolverBackend.
+ */
+class LinearSolverBackendSink : public LinearConstraintSink {
+
+public:
+
+	LinearSolverBackendSink(LinearSolverBackend& backend) : _backend(backend) {}
+
+	void addConstraints(const LinearConstraints& batch) override;
+
+private:
+
+	LinearSolverBackend& _backend;
+};
+
+/**
+ * A sink that collects all constraints in a LinearConstraints set.
+ */
+class LinearConstraintsSink : public LinearConstraintSink {
+
+public:
+
+	LinearConstraintsSink(LinearConstraints& constraints) : _constraints(constraints) {}
+
+	void addConstraints(const LinearConstraints& batch) override { _constraints.addAll(batch); }
+
+private:
+
+	LinearConstraints& _constraints;
+};
+
+/**
+ * A sink that writes all constraints to a text file, one per line.
+ */
+class LinearConstraintFileSink : public LinearConstraintSink {
+
+public:
+
+	LinearConstraintFileSink(const std::string& filename);
+
+	void addConstraints(const LinearConstraints& batch) override;
+
+private:
+
+	std::ofstream _out;
+};
+
+/**
+ * Generates constraints in place into a buffer of a fixed number of
+ * constraints, which is passed to a sink whenever it is full:
+ *
+ *   LinearConstraintStream stream(sink);
+ *   stream.emplace(LessEqual, 0.0)
+ *       .setCoefficient(u,  1.0)
+ *       .setCoefficient(v, -1.0);
+ *   ...
+ *   stream.flush();
+ *
+ * flush() has to be called after the last constraint was added.
+ */
+class LinearConstraintStream {
+
+public:
+
+	/**
+	 * Create a stream writing into the given sink.
+	 *
+	 * @param sink      The sink to receive the constraints.
+	 * @param batchSize The number of constraints to pass to the sink at once.
+	 */
+	LinearConstraintStream(LinearConstraintSink& sink, std::size_t batchSize = 1 << 16);
+
+	/**
+	 * Add a constraint without coefficients, return a builder to set them in
+	 * place. The builder is only valid until the next constraint is added.
+	 */
+	LinearConstraints::Builder emplace(Relation relation, double value);
+
+	/**
+	 * Add a set of constraints after the ones added so far. The set is passed
+	 * to the sink directly, without copying it into the buffer.
+	 */
+	void add(const LinearConstraints& constraints);
+
+	/**
+	 * Pass all buffered constraints to the sink.
+	 */
+	void flush();
+
+	/**
+	 * The number of constraints added to this stream so far.
+	 */
+	std::size_t size() const { return _numFlushed + _batch.size(); }
+
+	/**
+	 * The number of constraints passed to the sink at once.
+	 */
+	std::size_t getBatchSize() const { return _batchSize; }
+
+private:
+
+	LinearConstraintSink& _sink;
+	std::size_t           _batchSize;
+	std::size_t           _numFlushed;
+
+	LinearConstraints     _batch;
+};
+
+#endif // INFERENCE_LINEAR_CONSTRAINT_SINK_H__
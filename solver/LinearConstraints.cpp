@@ -1,20 +1,152 @@
+#include <algorithm>
+#include <cmath>
 #include "LinearConstraints.h"
 
-LinearConstraints::LinearConstraints(size_t size) {
+bool
+LinearConstraintView::isViolated(const Solution& solution, double tolerance) const {
 
-	_linearConstraints.resize(size);
+	double s = 0;
+
+	for (std::size_t i = 0; i < _numCoefficients; i++)
+		s += _coefs[i]*solution[_varNums[i]];
+
+	if (_relation == LessEqual)
+		return s > _value + tolerance;
+	else if (_relation == GreaterEqual)
+		return s < _value - tolerance;
+	else
+		return std::fabs(s - _value) > tolerance;
+}
+
+LinearConstraint
+LinearConstraintView::toLinearConstraint() const {
+
+	LinearConstraint constraint;
+
+	for (std::size_t i = 0; i < _numCoefficients; i++)
+		constraint.setCoefficient(_varNums[i], _coefs[i]);
+	constraint.setRelation(_relation);
+	constraint.setValue(_value);
+
+	return constraint;
+}
+
+std::ostream& operator<<(std::ostream& out, const LinearConstraintView& constraint) {
+
+	for (std::size_t i = 0; i < constraint.size(); i++)
+		out << constraint.getCoefficient(i) << "*" << constraint.getVarNum(i) << " ";
+
+	out << (constraint.getRelation() == LessEqual ? "<=" : (constraint.getRelation() == GreaterEqual ? ">=" : "=="));
+
+	out << " " << constraint.getValue();
+
+	return out;
+}
+
+LinearConstraints::Builder&
+LinearConstraints::Builder::setCoefficient(unsigned int varNum, double coef) {
+
+	std::vector<unsigned int>& varNums = _constraints._varNums;
+	std::vector<double>&       coefs   = _constraints._coefs;
+	std::size_t&               end     = _constraints._rowOffsets.back();
+	const std::size_t          begin   = _constraints._rowOffsets[_constraints._rowOffsets.size() - 2];
+
+	// keep the coefficients sorted by variable number, constraints are short
+	// and usually built in order, so search from the back
+	std::size_t i = end;
+	while (i > begin && varNums[i-1] > varNum)
+		i--;
+
+	if (i > begin && varNums[i-1] == varNum) {
+
+		if (coef == 0) {
+
+			varNums.erase(varNums.begin() + i - 1);
+			coefs.erase(coefs.begin() + i - 1);
+			end--;
+
+		} else {
+
+			coefs[i-1] = coef;
+		}
+
+		return *this;
+	}
+
+	if (coef == 0)
+		return *this;
+
+	varNums.insert(varNums.begin() + i, varNum);
+	coefs.insert(coefs.begin() + i, coef);
+	end++;
+
+	return *this;
+}
+
+LinearConstraints::LinearConstraints(size_t size) :
+	_rowOffsets(1, 0) {
+
+	_rowOffsets.reserve(size + 1);
+	_relations.reserve(size);
+	_values.reserve(size);
+}
+
+void
+LinearConstraints::reserve(std::size_t numConstraints, std::size_t numCoefficients) {
+
+	_rowOffsets.reserve(numConstraints + 1);
+	_relations.reserve(numConstraints);
+	_values.reserve(numConstraints);
+	_varNums.reserve(numCoefficients);
+	_coefs.reserve(numCoefficients);
+}
+
+void
+LinearConstraints::clear() {
+
+	_rowOffsets.assign(1, 0);
+	_varNums.clear();
+	_coefs.clear();
+	_relations.clear();
+	_values.clear();
 }
 
 void
 LinearConstraints::add(const LinearConstraint& linearConstraint) {
 
-	_linearConstraints.push_back(linearConstraint);
+	for (const auto& pair : linearConstraint.getCoefficients()) {
+
+		_varNums.push_back(pair.first);
+		_coefs.push_back(pair.second);
+	}
+
+	_rowOffsets.push_back(_varNums.size());
+	_relations.push_back(linearConstraint.getRelation());
+	_values.push_back(linearConstraint.getValue());
+}
+
+LinearConstraints::Builder
+LinearConstraints::emplace(Relation relation, double value) {
+
+	_rowOffsets.push_back(_varNums.size());
+	_relations.push_back(relation);
+	_values.push_back(value);
+
+	return Builder(*this);
 }
 
 void
 LinearConstraints::addAll(const LinearConstraints& linearConstraints) {
 
-	_linearConstraints.insert(_linearConstraints.end(), linearConstraints.begin(), linearConstraints.end());
+	const std::size_t offset = _varNums.size();
+
+	for (std::size_t i = 1; i < linearConstraints._rowOffsets.size(); i++)
+		_rowOffsets.push_back(offset + linearConstraints._rowOffsets[i]);
+
+	_varNums.insert(_varNums.end(), linearConstraints._varNums.begin(), linearConstraints._varNums.end());
+	_coefs.insert(_coefs.end(), linearConstraints._coefs.begin(), linearConstraints._coefs.end());
+	_relations.insert(_relations.end(), linearConstraints._relations.begin(), linearConstraints._relations.end());
+	_values.insert(_values.end(), linearConstraints._values.begin(), linearConstraints._values.end());
 }
 
 std::vector<unsigned int>
@@ -24,11 +156,12 @@ LinearConstraints::getConstraints(const std::vector<unsigned int>& variableIds)
 
 	for (unsigned int i = 0; i < size(); i++) {
 
-		LinearConstraint& constraint = _linearConstraints[i];
+		const unsigned int* begin = _varNums.data() + _rowOffsets[i];
+		const unsigned int* end   = _varNums.data() + _rowOffsets[i+1];
 
 		for (unsigned int v : variableIds) {
 
-			if (constraint.getCoefficients().count(v) != 0) {
+			if (std::binary_search(begin, end, v)) {
 
 				indices.push_back(i);
 				break;
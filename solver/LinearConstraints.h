@@ -1,17 +1,140 @@
 #ifndef INFERENCE_LINEAR_CONSTRAINTS_H__
 #define INFERENCE_LINEAR_CONSTRAINTS_H__
 
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
 #include "LinearConstraint.h"
 
-class LinearConstraints {
+/**
+ * Read-only view on one constraint of a LinearConstraints set. Coefficients
+ * are sorted by variable number, as for LinearConstraint. The view is
+ * invalidated when constraints are added to the set.
+ */
+class LinearConstraintView {
+
+public:
+
+	LinearConstraintView(
+			const unsigned int* varNums,
+			const double*       coefs,
+			std::size_t         numCoefficients,
+			Relation            relation,
+			double              value) :
+		_varNums(varNums),
+		_coefs(coefs),
+		_numCoefficients(numCoefficients),
+		_relation(relation),
+		_value(value) {}
+
+	/**
+	 * The number of non-zero coefficients.
+	 */
+	std::size_t size() const { return _numCoefficients; }
+
+	/**
+	 * The variable number of the i-th non-zero coefficient.
+	 */
+	unsigned int getVarNum(std::size_t i) const { return _varNums[i]; }
+
+	/**
+	 * The value of the i-th non-zero coefficient.
+	 */
+	double getCoefficient(std::size_t i) const { return _coefs[i]; }
+
+	Relation getRelation() const { return _relation; }
+
+	double getValue() const { return _value; }
 
-	typedef std::vector<LinearConstraint> linear_constraints_type;
+	/**
+	 * Check whether the given solution violates this constraint by more than
+	 * the given tolerance.
+	 */
+	bool isViolated(const Solution& solution, double tolerance = 0) const;
+
+	/**
+	 * Create a LinearConstraint with the same coefficients, relation, and
+	 * value.
+	 */
+	LinearConstraint toLinearConstraint() const;
+
+private:
+
+	const unsigned int* _varNums;
+	const double*       _coefs;
+	std::size_t         _numCoefficients;
+	Relation            _relation;
+	double              _value;
+};
+
+std::ostream& operator<<(std::ostream& out, const LinearConstraintView& constraint);
+
+/**
+ * A set of linear constraints, stored in one contiguous arena in compressed
+ * sparse row (CSR) format: the coefficients of constraint i are stored at
+ * positions getRowOffsets()[i],...,getRowOffsets()[i+1]-1 of getVarNums() and
+ * getCoefficients().
+ *
+ * Constraints are added either by copying a LinearConstraint, or in place
+ * with emplace(), which returns a Builder to append the coefficients:
+ *
+ *   constraints.emplace(LessEqual, 0.0)
+ *       .setCoefficient(u,  1.0)
+ *       .setCoefficient(v, -1.0);
+ *
+ * Sets of constraints can be moved, but not copied.
+ */
+class LinearConstraints {
 
 public:
 
-	typedef linear_constraints_type::iterator       iterator;
+	/**
+	 * Appends coefficients to the last constraint of a LinearConstraints set.
+	 * Only valid until the next constraint is added.
+	 */
+	class Builder {
+
+	public:
+
+		Builder(LinearConstraints& constraints) : _constraints(constraints) {}
+
+		/**
+		 * Set the coefficient of a variable. Like for LinearConstraint, a
+		 * coefficient of zero removes the variable, and setting the
+		 * coefficient of a variable twice overwrites the first value.
+		 */
+		Builder& setCoefficient(unsigned int varNum, double coef);
 
-	typedef linear_constraints_type::const_iterator const_iterator;
+	private:
+
+		LinearConstraints& _constraints;
+	};
+
+	/**
+	 * Iterates over the constraints of a set, yielding LinearConstraintViews.
+	 */
+	class const_iterator {
+
+	public:
+
+		const_iterator(const LinearConstraints& constraints, std::size_t i) :
+			_constraints(&constraints),
+			_i(i) {}
+
+		LinearConstraintView operator*() const { return (*_constraints)[_i]; }
+
+		const_iterator& operator++() { _i++; return *this; }
+
+		bool operator==(const const_iterator& other) const { return _i == other._i; }
+
+		bool operator!=(const const_iterator& other) const { return _i != other._i; }
+
+	private:
+
+		const LinearConstraints* _constraints;
+		std::size_t _i;
+	};
 
 	/**
 	 * Create a new set of linear constraints and allocate enough memory to hold
@@ -23,10 +146,24 @@ public:
 	 */
 	LinearConstraints(size_t size = 0);
 
+	LinearConstraints(LinearConstraints&& other) = default;
+
+	LinearConstraints& operator=(LinearConstraints&& other) = default;
+
+	LinearConstraints(const LinearConstraints& other) = delete;
+
+	LinearConstraints& operator=(const LinearConstraints& other) = delete;
+
+	/**
+	 * Reserve memory for the given number of constraints and non-zero
+	 * coefficients in total.
+	 */
+	void reserve(std::size_t numConstraints, std::size_t numCoefficients);
+
 	/**
 	 * Remove all constraints from this set of linear constraints.
 	 */
-	void clear() { _linearConstraints.clear(); }
+	void clear();
 
 	/**
 	 * Add a linear constraint.
@@ -35,6 +172,15 @@ public:
 	 */
 	void add(const LinearConstraint& linearConstraint);
 
+	/**
+	 * Add a linear constraint without coefficients, return a builder to set
+	 * them in place.
+	 *
+	 * @param relation The relation of the new constraint.
+	 * @param value    The right hand side of the new constraint.
+	 */
+	Builder emplace(Relation relation, double value);
+
 	/**
 	 * Add a set of linear constraints.
 	 *
@@ -45,30 +191,48 @@ public:
 	/**
 	 * @return The number of linear constraints in this set.
 	 */
-	unsigned int size() const { return _linearConstraints.size(); }
-
-	const const_iterator begin() const { return _linearConstraints.begin(); }
+	unsigned int size() const { return _relations.size(); }
 
-	iterator begin() { return _linearConstraints.begin(); }
+	const_iterator begin() const { return const_iterator(*this, 0); }
 
-	const const_iterator end() const { return _linearConstraints.end(); }
+	const_iterator end() const { return const_iterator(*this, size()); }
 
-	iterator end() { return _linearConstraints.end(); }
+	LinearConstraintView operator[](size_t i) const {
 
-	const LinearConstraint& operator[](size_t i) const { return _linearConstraints[i]; }
-
-	LinearConstraint& operator[](size_t i) { return _linearConstraints[i]; }
+		return LinearConstraintView(
+				_varNums.data() + _rowOffsets[i],
+				_coefs.data() + _rowOffsets[i],
+				_rowOffsets[i+1] - _rowOffsets[i],
+				_relations[i],
+				_values[i]);
+	}
 
 	/**
-	 * Get a linst of indices of linear constraints that use the given 
+	 * Get a linst of indices of linear constraints that use the given
 	 * variables.
 	 */
 	std::vector<unsigned int> getConstraints(const std::vector<unsigned int>& variableIds);
 
+	/**
+	 * Access to the CSR arrays, e.g., to pass them to
+	 * LinearSolverBackend::addConstraints().
+	 */
+	const std::vector<std::size_t>&  getRowOffsets() const { return _rowOffsets; }
+	const std::vector<unsigned int>& getVarNums() const { return _varNums; }
+	const std::vector<double>&       getCoefficients() const { return _coefs; }
+	const std::vector<Relation>&     getRelations() const { return _relations; }
+	const std::vector<double>&       getValues() const { return _values; }
+
 private:
 
-	linear_constraints_type _linearConstraints;
+	// size()+1 offsets into _varNums and _coefs
+	std::vector<std::size_t>  _rowOffsets;
+
+	std::vector<unsigned int> _varNums;
+	std::vector<double>       _coefs;
+
+	std::vector<Relation>     _relations;
+	std::vector<double>       _values;
 };
 
 #endif // INFERENCE_LINEAR_CONSTRAINTS_H__
-
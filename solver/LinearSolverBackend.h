@@ -1,6 +1,8 @@
 #ifndef INFERENCE_LINEAR_SOLVER_BACKEND_H__
 #define INFERENCE_LINEAR_SOLVER_BACKEND_H__
 
+#include <algorithm>
+#include <cstddef>
 #include <util/exceptions.h>
 #include "LinearObjective.h"
 #include "LinearConstraints.h"
@@ -66,6 +68,35 @@ public:
 			VariableType                                defaultVariableType,
 			const std::map<unsigned int, VariableType>& specialVariableTypes) = 0;
 
+	/**
+	 * Initialise the linear solver for the given type of variables and bounds.
+	 *
+	 * @param numVariables
+	 *             The number of variables in the problem.
+	 *
+	 * @param defaultVariableType
+	 *             The default type of the variables (Continuous, Integer,
+	 *             Binary).
+	 *
+	 * @param specialVariableTypes
+	 *             A map of variable numbers to variable types to override the
+	 *             default.
+	 *
+	 * @param lowerBounds
+	 *             The lower bound of each variable, or empty to use the
+	 *             default bounds of the variable types.
+	 *
+	 * @param upperBounds
+	 *             The upper bound of each variable, or empty to use the
+	 *             default bounds of the variable types.
+	 */
+	virtual void initialize(
+			unsigned int                                numVariables,
+			VariableType                                defaultVariableType,
+			const std::map<unsigned int, VariableType>& specialVariableTypes,
+			const std::vector<double>&                  lowerBounds,
+			const std::vector<double>&                  upperBounds) = 0;
+
 	/**
 	 * Set the objective.
 	 *
@@ -73,6 +104,25 @@ public:
 	 */
 	virtual void setObjective(const LinearObjective& objective) = 0;
 
+	/**
+	 * Change some linear coefficients of the objective set with
+	 * setObjective(), keeping the rest of the model.
+	 *
+	 * @param varNums The numbers of the variables to change.
+	 * @param coefs   The new coefficients of these variables.
+	 */
+	virtual void setObjectiveCoefficients(
+			const std::vector<unsigned int>& varNums,
+			const std::vector<double>&       coefs) = 0;
+
+	/**
+	 * Set an initial solution to start the search from (a MIP start) for the
+	 * next call to solve(). Solvers may ignore solutions that are infeasible.
+	 *
+	 * @param solution A value for each variable.
+	 */
+	virtual void setInitialSolution(const Solution& solution) = 0;
+
 	/**
 	 * Set the linear (in)equality constraints.
 	 *
@@ -87,6 +137,40 @@ public:
 	 */
 	virtual void addConstraint(const LinearConstraint& constraint) = 0;
 
+	/**
+	 * Add many constraints at once, given in compressed sparse row (CSR)
+	 * format. The coefficients of constraint i are values[k] for the variables
+	 * columns[k], with rowOffsets[i] <= k < rowOffsets[i+1].
+	 *
+	 * The default implementation adds the constraints one by one.
+	 *
+	 * @param numConstraints The number of constraints to add.
+	 * @param rowOffsets     numConstraints+1 offsets into columns and values.
+	 * @param columns        The variable numbers of the coefficients.
+	 * @param values         The coefficients.
+	 * @param relations      The relation of each constraint.
+	 * @param rhs            The right hand side of each constraint.
+	 */
+	virtual void addConstraints(
+			std::size_t         numConstraints,
+			const std::size_t*  rowOffsets,
+			const unsigned int* columns,
+			const double*       values,
+			const Relation*     relations,
+			const double*       rhs) {
+
+		for (std::size_t i = 0; i < numConstraints; i++) {
+
+			LinearConstraint constraint;
+			for (std::size_t k = rowOffsets[i]; k < rowOffsets[i+1]; k++)
+				constraint.setCoefficient(columns[k], values[k]);
+			constraint.setRelation(relations[i]);
+			constraint.setValue(rhs[i]);
+
+			addConstraint(constraint);
+		}
+	}
+
 	/**
 	 * Solve the problem.
 	 *
@@ -98,6 +182,59 @@ public:
 	virtual bool solve(Solution& solution, std::string& message, const Parameters& parameters = Parameters()) = 0;
 
 	virtual void dumpProblem(std::string filename) { UTIL_THROW_EXCEPTION(NotYetImplemented, "this solver does not supporting dumping"); }
+
+protected:
+
+	/**
+	 * Ensure that an initial solution contains one value per variable.
+	 */
+	void checkInitialSolution(unsigned int numVariables, const Solution& solution) {
+
+		if (solution.size() != numVariables)
+			UTIL_THROW_EXCEPTION(
+					UsageError,
+					"expected an initial solution for " << numVariables << " variables, got " << solution.size());
+	}
+
+	/**
+	 * Ensure that the given bounds are either empty or contain one value per
+	 * variable.
+	 */
+	void checkBounds(
+			unsigned int               numVariables,
+			const std::vector<double>& lowerBounds,
+			const std::vector<double>& upperBounds) {
+
+		if (!lowerBounds.empty() && lowerBounds.size() != numVariables)
+			UTIL_THROW_EXCEPTION(
+					UsageError,
+					"expected " << numVariables << " lower bounds, got " << lowerBounds.size());
+
+		if (!upperBounds.empty() && upperBounds.size() != numVariables)
+			UTIL_THROW_EXCEPTION(
+					UsageError,
+					"expected " << numVariables << " upper bounds, got " << upperBounds.size());
+	}
+
+	/**
+	 * Pass a set of constraints to addConstraints(), in slices of at most
+	 * batchSize constraints of its CSR arrays.
+	 */
+	void addConstraintsInBatches(const LinearConstraints& constraints, std::size_t batchSize = 1 << 16) {
+
+		for (std::size_t begin = 0; begin < constraints.size(); begin += batchSize) {
+
+			std::size_t end = std::min(begin + batchSize, static_cast<std::size_t>(constraints.size()));
+
+			addConstraints(
+					end - begin,
+					constraints.getRowOffsets().data() + begin,
+					constraints.getVarNums().data(),
+					constraints.getCoefficients().data(),
+					constraints.getRelations().data() + begin,
+					constraints.getValues().data() + begin);
+		}
+	}
 };
 
 class LinearSolverBackendException : public Exception {};
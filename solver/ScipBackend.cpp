@@ -2,6 +2,7 @@
 
 #ifdef HAVE_SCIP
 
+#include <cstdio>
 #include <sstream>
 
 #include <scip/scipdefplugins.h>
@@ -48,6 +49,19 @@ ScipBackend::initialize(
 		VariableType                                defaultVariableType,
 		const std::map<unsigned int, VariableType>& specialVariableTypes) {
 
+	initialize(numVariables, defaultVariableType, specialVariableTypes, std::vector<double>(), std::vector<double>());
+}
+
+void
+ScipBackend::initialize(
+		unsigned int                                numVariables,
+		VariableType                                defaultVariableType,
+		const std::map<unsigned int, VariableType>& specialVariableTypes,
+		const std::vector<double>&                  lowerBounds,
+		const std::vector<double>&                  upperBounds) {
+
+	checkBounds(numVariables, lowerBounds, upperBounds);
+
 	if (sciplog.getLogLevel() >= Debug)
 		setVerbose(true);
 	else
@@ -71,6 +85,11 @@ ScipBackend::initialize(
 				specialVariableTypes.count(i) ? specialVariableTypes.at(i) : defaultVariableType,
 				lb, ub);
 
+		if (!lowerBounds.empty())
+			lb = lowerBounds[i];
+		if (!upperBounds.empty())
+			ub = upperBounds[i];
+
 		SCIP_CALL_ABORT(SCIPcreateVarBasic(_scip, &v, name.c_str(), lb, ub, 0 /* obj */, type));
 		SCIP_CALL_ABORT(SCIPaddVar(_scip, v));
 
@@ -120,6 +139,38 @@ ScipBackend::setObjective(const QuadraticObjective& objective) {
 				"You can do so by converting min xQx into min z s.t. z >= xQx");
 }
 
+void
+ScipBackend::setObjectiveCoefficients(
+		const std::vector<unsigned int>& varNums,
+		const std::vector<double>&       coefs) {
+
+	LOG_DEBUG(sciplog) << "changing " << varNums.size() << " linear coefficients" << std::endl;
+
+	for (unsigned int i = 0; i < varNums.size(); i++)
+		SCIP_CALL_ABORT(SCIPchgVarObj(_scip, _variables[varNums[i]], coefs[i]));
+}
+
+void
+ScipBackend::setInitialSolution(const Solution& solution) {
+
+	checkInitialSolution(_numVariables, solution);
+
+	LOG_DEBUG(sciplog) << "setting initial solution" << std::endl;
+
+	SCIP_SOL* sol;
+	SCIP_CALL_ABORT(SCIPcreateSol(_scip, &sol, NULL));
+
+	for (unsigned int i = 0; i < _numVariables; i++)
+		SCIP_CALL_ABORT(SCIPsetSolVal(_scip, sol, _variables[i], solution[i]));
+
+	// frees the solution, also if it was rejected
+	SCIP_Bool stored;
+	SCIP_CALL_ABORT(SCIPaddSolFree(_scip, &sol, &stored));
+
+	if (!stored)
+		LOG_DEBUG(sciplog) << "initial solution was not accepted" << std::endl;
+}
+
 void
 ScipBackend::setConstraints(const LinearConstraints& constraints) {
 
@@ -131,17 +182,7 @@ ScipBackend::setConstraints(const LinearConstraints& constraints) {
 
 	LOG_DEBUG(sciplog) << "setting " << constraints.size() << " constraints" << std::endl;
 
-	unsigned int j = 0;
-	for (const LinearConstraint& constraint : constraints) {
-
-		if (j > 0)
-			if (j % 1000 == 0)
-				LOG_ALL(sciplog) << "" << j << " constraints set so far" << std::endl;
-
-		addConstraint(constraint);
-
-		j++;
-	}
+	addConstraintsInBatches(constraints);
 }
 
 void
@@ -176,6 +217,53 @@ ScipBackend::addConstraint(const LinearConstraint& constraint) {
 	SCIP_CALL_ABORT(SCIPreleaseCons(_scip, &c));
 }
 
+void
+ScipBackend::addConstraints(
+		std::size_t         numConstraints,
+		const std::size_t*  rowOffsets,
+		const unsigned int* columns,
+		const double*       values,
+		const Relation*     relations,
+		const double*       rhs) {
+
+	LOG_ALL(sciplog) << "adding " << numConstraints << " constraints" << std::endl;
+
+	_constraints.reserve(_constraints.size() + numConstraints);
+
+	// SCIP has no batch interface, but each constraint can be created with
+	// all its coefficients at once
+	std::vector<SCIP_VAR*> vars;
+	char name[32];
+
+	for (std::size_t i = 0; i < numConstraints; i++) {
+
+		const std::size_t begin = rowOffsets[i];
+		const std::size_t end   = rowOffsets[i+1];
+
+		vars.resize(end - begin);
+		for (std::size_t k = begin; k < end; k++)
+			vars[k - begin] = _variables[columns[k]];
+
+		std::snprintf(name, sizeof(name), "c%zu", _constraints.size());
+
+		SCIP_CONS* c;
+		SCIP_CALL_ABORT(SCIPcreateConsBasicLinear(
+				_scip,
+				&c,
+				name,
+				end - begin,
+				vars.data(),
+				const_cast<double*>(values + begin),
+				(relations[i] == Equal ? rhs[i] : (relations[i] == LessEqual ? -SCIPinfinity(_scip) : rhs[i])),
+				(relations[i] == Equal ? rhs[i] : (relations[i] == LessEqual ? rhs[i] : SCIPinfinity(_scip)))));
+
+		_constraints.push_back(c);
+
+		SCIP_CALL_ABORT(SCIPaddCons(_scip, c));
+		SCIP_CALL_ABORT(SCIPreleaseCons(_scip, &c));
+	}
+}
+
 bool
 ScipBackend::solve(Solution& x, std::string& msg, const LinearSolverBackend::Parameters& parameters) {
 
@@ -0,0 +1,437 @@
+#include <algorithm>
+#include <limits>
+#include <util/Logger.h>
+#include <util/exceptions.h>
+#include "GridSurfaceSolver.h"
+
+logger::LogChannel gridsurfacesolverlog("gridsurfacesolverlog", "[GridSurfaceSolver] ");
+
+GridSurfaceSolver::GridSurfaceSolver(
+		const std::vector<std::size_t>& shape,
+		int num_levels,
+		int connectivity,
+		const std::vector<int>& max_gradients) :
+	_topology(shape, connectivity, max_gradients),
+	_num_levels(num_levels),
+	_level_costs(num_levels),
+	_neighbors(_topology.num_nodes(), 0),
+	_num_directions(2*_topology.num_offsets()),
+	_has_holes(false),
+	_infinite_label(0),
+	_work_since_global_relabel(0) {
+
+	if (num_levels < 1)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"at least one level is needed, got " << num_levels);
+
+	// the directions of a node are stored as bits of an unsigned int
+	if (shape.size() > 3)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"only grids with up to three dimensions are supported, got " << shape.size());
+
+	_level_costs.resize(_topology.num_nodes());
+
+	for (std::size_t i = 0; i < _topology.num_offsets(); i++) {
+
+		_direction_strides.push_back( _topology.offset_stride(i));
+		_direction_strides.push_back(-_topology.offset_stride(i));
+		_direction_gradients.push_back(_topology.offset_max_gradient(i));
+		_direction_gradients.push_back(_topology.offset_max_gradient(i));
+	}
+
+	_topology.for_each_offset_edge([&](NodeId u, NodeId v, std::size_t i) {
+
+		_neighbors[u] |= (1u << (2*i));
+		_neighbors[v] |= (1u << (2*i + 1));
+	});
+}
+
+void
+GridSurfaceSolver::set_level_costs(NodeId n, const std::vector<double>& costs) {
+
+	if (n >= num_nodes())
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"node " << n << " is not part of the grid with " << num_nodes() << " nodes");
+
+	if (costs.size() != static_cast<std::size_t>(_num_levels))
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"expected " << _num_levels << " level costs, got " << costs.size());
+
+	_level_costs.set(n, costs);
+}
+
+double
+GridSurfaceSolver::min_surface() {
+
+	const std::size_t num_nodes = _topology.num_nodes();
+
+	_statistics = IlpSolver::Statistics();
+	_statistics.engine = IlpSolver::MinCut;
+
+	find_level_ranges();
+
+	// the closure graph has a node for each indicator [h[n] >= l] with
+	// 0 < l < num_levels, of which the ones outside of the ranges are fixed
+	// and never take part in the flow
+	const std::size_t num_closure_nodes = num_nodes*(_num_levels - 1);
+	std::size_t num_variables = 0;
+	for (NodeId n = 0; n < num_nodes; n++)
+		num_variables += _max_levels[n] - _min_levels[n];
+
+	_statistics.num_removed_variables = num_closure_nodes - num_variables;
+
+	LOG_DEBUG(gridsurfacesolverlog)
+			<< "solving " << num_nodes << " columns with " << _num_levels << " levels, "
+			<< num_variables << " of " << num_closure_nodes << " indicators are variables" << std::endl;
+
+	// the initial preflow saturates the arcs from the source: closure nodes
+	// with negative accumulated costs have an excess, the others a residual
+	// capacity to the sink
+	_excess.assign(num_closure_nodes, 0);
+	for (NodeId n = 0; n < num_nodes; n++)
+		for (int l = _min_levels[n] + 1; l <= _max_levels[n]; l++)
+			_excess[closure_node(n, l)] = -_level_costs.accumulated(n, l);
+
+	_label.assign(num_closure_nodes, 0);
+	// larger than any distance to the sink
+	_infinite_label = static_cast<int>(std::min<std::size_t>(num_variables + 1, std::numeric_limits<int>::max()));
+
+	_down_flow.assign(num_closure_nodes, 0);
+	_up_flow.assign(_has_holes ? num_closure_nodes : 0, 0);
+	_direction_flow.assign(num_closure_nodes*_num_directions, 0);
+
+	max_preflow();
+
+	// the closure nodes that can not reach the sink anymore form the source
+	// side of the minimal cut, which contains the lowest levels of each
+	// column up to the level of the surface
+	_levels.resize(num_nodes);
+	double value = 0;
+	for (NodeId n = 0; n < num_nodes; n++) {
+
+		int level = _min_levels[n];
+		while (level < _max_levels[n] && _label[closure_node(n, level + 1)] >= _infinite_label)
+			level++;
+
+		_levels[n] = level;
+		value += _level_costs(n, level);
+	}
+
+	// release the memory of the flow
+	_excess = std::vector<double>();
+	_label = std::vector<int>();
+	_down_flow = std::vector<double>();
+	_up_flow = std::vector<double>();
+	_direction_flow = std::vector<double>();
+	_queued = std::vector<bool>();
+
+	return value;
+}
+
+int
+GridSurfaceSolver::level(NodeId n) {
+
+	if (n >= _levels.size())
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"no level found for node " << n << ", call min_surface() first");
+
+	return _levels[n];
+}
+
+void
+GridSurfaceSolver::find_level_ranges() {
+
+	const std::size_t num_nodes = _topology.num_nodes();
+
+	_min_levels.assign(num_nodes, 0);
+	_max_levels.assign(num_nodes, _num_levels - 1);
+
+	// levels with infinite costs at the bottom or top of a column can not be
+	// selected
+	for (NodeId n = 0; n < num_nodes; n++) {
+
+		while (_min_levels[n] <= _max_levels[n] && std::isinf(_level_costs(n, _min_levels[n])))
+			_min_levels[n]++;
+		while (_max_levels[n] >= _min_levels[n] && std::isinf(_level_costs(n, _max_levels[n])))
+			_max_levels[n]--;
+
+		if (_min_levels[n] > _max_levels[n])
+			UTIL_THROW_EXCEPTION(
+					Exception,
+					"all levels of node " << n << " have infinite costs");
+	}
+
+	// make the ranges arc-consistent with the gradient constraints, skipping
+	// levels with infinite costs whenever a bound moves (as in
+	// IlpSolver::find_level_ranges(), this detects all infeasible problems
+	// and guarantees that the closure graph has a cut of finite costs)
+	std::deque<NodeId> queue;
+	std::vector<bool> queued(num_nodes, true);
+	for (NodeId n = 0; n < num_nodes; n++)
+		queue.push_back(n);
+
+	while (!queue.empty()) {
+
+		NodeId u = queue.front();
+		queue.pop_front();
+		queued[u] = false;
+
+		for (int j = 0; j < _num_directions; j++) {
+
+			if (!(_neighbors[u] & (1u << j)))
+				continue;
+
+			NodeId v = u + _direction_strides[j];
+			int g = _direction_gradients[j];
+
+			bool changed = false;
+			if (_min_levels[v] < _min_levels[u] - g) {
+
+				_min_levels[v] = _min_levels[u] - g;
+				while (_min_levels[v] <= _max_levels[v] && std::isinf(_level_costs(v, _min_levels[v])))
+					_min_levels[v]++;
+				changed = true;
+			}
+			if (_max_levels[v] > _max_levels[u] + g) {
+
+				_max_levels[v] = _max_levels[u] + g;
+				while (_max_levels[v] >= _min_levels[v] && std::isinf(_level_costs(v, _max_levels[v])))
+					_max_levels[v]--;
+				changed = true;
+			}
+
+			if (_min_levels[v] > _max_levels[v])
+				UTIL_THROW_EXCEPTION(
+						Exception,
+						"there is no surface that satisfies the gradient constraints at node " << v);
+
+			if (changed && !queued[v]) {
+
+				queue.push_back(v);
+				queued[v] = true;
+			}
+		}
+	}
+
+	_has_holes = false;
+	for (NodeId n = 0; n < num_nodes && !_has_holes; n++)
+		for (int l = _min_levels[n] + 1; l < _max_levels[n]; l++)
+			if (std::isinf(_level_costs(n, l))) {
+
+				_has_holes = true;
+				break;
+			}
+}
+
+void
+GridSurfaceSolver::max_preflow() {
+
+	const std::size_t num_closure_nodes = _excess.size();
+
+	_queued.assign(num_closure_nodes, false);
+	_active.clear();
+
+	global_relabel();
+
+	while (!_active.empty()) {
+
+		std::size_t a = _active.front();
+		_active.pop_front();
+		_queued[a] = false;
+
+		discharge(a);
+
+		// relabel globally once the relabelings scanned about as many arcs
+		// as there are closure nodes
+		if (_work_since_global_relabel > num_closure_nodes)
+			global_relabel();
+	}
+
+	// find the nodes that can still reach the sink
+	global_relabel();
+}
+
+void
+GridSurfaceSolver::discharge(std::size_t a) {
+
+	while (_excess[a] > 0 && _label[a] < _infinite_label) {
+
+		// push along admissible arcs, and find the lowest label of the other
+		// residual arcs for the relabeling (arcs that flow was pushed over are
+		// saturated if excess remains)
+		int label = _infinite_label;
+		for_each_residual_arc(a, [&](std::size_t b, double* flow, bool forward) {
+
+			if (!forward && *flow <= 0)
+				return;
+
+			if (_excess[a] <= 0 || _label[b] != _label[a] - 1) {
+
+				if (_label[b] < _infinite_label)
+					label = std::min(label, _label[b] + 1);
+				return;
+			}
+
+			double delta = (forward ? _excess[a] : std::min(_excess[a], *flow));
+
+			*flow += (forward ? delta : -delta);
+			_excess[a] -= delta;
+
+			bool was_active = (_excess[b] > 0);
+			_excess[b] += delta;
+
+			if (!was_active && _excess[b] > 0 && _label[b] < _infinite_label && !_queued[b]) {
+
+				_active.push_back(b);
+				_queued[b] = true;
+			}
+		});
+
+		if (_excess[a] <= 0)
+			break;
+
+		_label[a] = label;
+		_work_since_global_relabel += _num_directions + 2;
+	}
+}
+
+void
+GridSurfaceSolver::global_relabel() {
+
+	const std::size_t num_nodes = _topology.num_nodes();
+
+	// closure nodes with a residual capacity to the sink are at distance 1
+	std::vector<std::size_t> queue;
+	for (NodeId n = 0; n < num_nodes; n++)
+		for (int l = _min_levels[n] + 1; l <= _max_levels[n]; l++) {
+
+			std::size_t a = closure_node(n, l);
+
+			if (_excess[a] < 0) {
+
+				_label[a] = 1;
+				queue.push_back(a);
+
+			} else {
+
+				_label[a] = _infinite_label;
+			}
+		}
+
+	for (std::size_t i = 0; i < queue.size(); i++) {
+
+		std::size_t b = queue[i];
+		int label = _label[b] + 1;
+
+		if (label >= _infinite_label)
+			continue;
+
+		for_each_residual_predecessor(b, [&](std::size_t a) {
+
+			if (_label[a] == _infinite_label) {
+
+				_label[a] = label;
+				queue.push_back(a);
+			}
+		});
+	}
+
+	// nodes with excess that can still reach the sink are active
+	_active.clear();
+	for (NodeId n = 0; n < num_nodes; n++)
+		for (int l = _min_levels[n] + 1; l <= _max_levels[n]; l++) {
+
+			std::size_t a = closure_node(n, l);
+
+			_queued[a] = (_excess[a] > 0 && _label[a] < _infinite_label);
+			if (_queued[a])
+				_active.push_back(a);
+		}
+
+	_work_since_global_relabel = 0;
+}
+
+template <typename F>
+void
+GridSurfaceSolver::for_each_residual_arc(std::size_t a, F f) {
+
+	const NodeId n = a/(_num_levels - 1);
+	const int    l = a%(_num_levels - 1) + 1;
+
+	// x[n,l] => x[n,l-1]
+	if (l - 1 > _min_levels[n])
+		f(a - 1, &_down_flow[a], true);
+	if (l < _max_levels[n])
+		f(a + 1, &_down_flow[a + 1], false);
+
+	// x[n,l] => x[n,l+1] for levels l with infinite costs
+	if (is_hole(n, l))
+		f(a + 1, &_up_flow[a], true);
+	if (l - 1 > _min_levels[n] && is_hole(n, l - 1))
+		f(a - 1, &_up_flow[a - 1], false);
+
+	// x[n,l] => x[m,l-g] for the neighbor m in direction j, the backward arcs
+	// are the ones of the neighbor in the opposite direction
+	const std::ptrdiff_t column_stride = _num_levels - 1;
+	for (int j = 0; j < _num_directions; j++) {
+
+		if (!(_neighbors[n] & (1u << j)))
+			continue;
+
+		NodeId m = n + _direction_strides[j];
+		int g = _direction_gradients[j];
+
+		if (l - g > _min_levels[m]) {
+
+			std::size_t b = a + _direction_strides[j]*column_stride - g;
+			f(b, &_direction_flow[a*_num_directions + j], true);
+		}
+
+		if (l + g <= _max_levels[m]) {
+
+			std::size_t b = a + _direction_strides[j]*column_stride + g;
+			f(b, &_direction_flow[b*_num_directions + (j ^ 1)], false);
+		}
+	}
+}
+
+template <typename F>
+void
+GridSurfaceSolver::for_each_residual_predecessor(std::size_t b, F f) const {
+
+	const NodeId n = b/(_num_levels - 1);
+	const int    l = b%(_num_levels - 1) + 1;
+
+	// arcs into b of infinite capacity, and backward arcs of arcs out of b
+	// with positive flow
+	if (l < _max_levels[n])
+		f(b + 1);
+	if (l - 1 > _min_levels[n] && _down_flow[b] > 0)
+		f(b - 1);
+
+	if (l - 1 > _min_levels[n] && is_hole(n, l - 1))
+		f(b - 1);
+	if (is_hole(n, l) && _up_flow[b] > 0)
+		f(b + 1);
+
+	const std::ptrdiff_t column_stride = _num_levels - 1;
+	for (int j = 0; j < _num_directions; j++) {
+
+		if (!(_neighbors[n] & (1u << j)))
+			continue;
+
+		NodeId m = n + _direction_strides[j];
+		int g = _direction_gradients[j];
+
+		if (l + g <= _max_levels[m])
+			f(b + _direction_strides[j]*column_stride + g);
+
+		if (l - g > _min_levels[m] && _direction_flow[b*_num_directions + j] > 0)
+			f(b + _direction_strides[j]*column_stride - g);
+	}
+}
@@ -0,0 +1,165 @@
+#ifndef PYSURFREC_SURFREC_GRID_SURFACE_SOLVER_H__
+#define PYSURFREC_SURFREC_GRID_SURFACE_SOLVER_H__
+
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include "GridTopology.h"
+#include "IlpSolver.h"
+#include "LevelCosts.h"
+
+/**
+ * A surface solver for regular 2D and 3D grids. In contrast to IlpSolver, the
+ * neighborhood of a node is given implicitly by the grid shape and
+ * connectivity, and neither the edges of the grid nor the arcs of the closure
+ * graph are stored.
+ *
+ * The closure graph has one node for each level above the lowest one of each
+ * column, stored column by column, such that the arcs of a node lead to nodes
+ * at fixed offsets. The minimal cut is found with a push-relabel algorithm
+ * that generates the arcs on the fly and only stores the flow over each of
+ * them. Levels that can not be part of any surface are fixed beforehand, as
+ * with IlpSolver::Parameters::presolve.
+ *
+ * Only gradient constraints are supported. For penalties, separations,
+ * zero-minimum constraints, or other engines, pass the grid to IlpSolver with
+ * IlpSolver::add_grid_edges().
+ */
+class GridSurfaceSolver {
+
+public:
+
+	typedef GridTopology::NodeId NodeId;
+
+	/**
+	 * Create a new solver for a grid of the given shape.
+	 *
+	 * @param shape
+	 *              The size of the grid along each axis (at most three).
+	 *              Nodes are enumerated in C order.
+	 * @param num_levels
+	 *              The number of levels in each column, i.e., the maximal
+	 *              height of the surface.
+	 * @param connectivity
+	 *              The number of neighbors of a node inside the grid (4 or 8
+	 *              in 2D, 6 or 26 in 3D).
+	 * @param max_gradients
+	 *              The maximal gradient of the surface along each axis, or a
+	 *              single value for all axes.
+	 */
+	GridSurfaceSolver(
+			const std::vector<std::size_t>& shape,
+			int num_levels,
+			int connectivity,
+			const std::vector<int>& max_gradients);
+
+	/**
+	 * The number of nodes (columns) in the grid.
+	 */
+	std::size_t num_nodes() const { return _topology.num_nodes(); }
+
+	/**
+	 * Set the costs for passing the surface through the different levels of a
+	 * column. Levels with infinite costs are excluded from the solution.
+	 */
+	void set_level_costs(NodeId n, const std::vector<double>& costs);
+
+	/**
+	 * Find the cost-minimal surface.
+	 */
+	double min_surface();
+
+	/**
+	 * Return the level where the found surface passes through the column of
+	 * node n.
+	 */
+	int level(NodeId n);
+
+	/**
+	 * Statistics about the last call to min_surface().
+	 */
+	const IlpSolver::Statistics& statistics() const { return _statistics; }
+
+private:
+
+	// narrow down the range of possible levels of each column, throw if there
+	// is no surface with finite costs
+	void find_level_ranges();
+
+	// find a maximal preflow with a FIFO push-relabel algorithm
+	void max_preflow();
+
+	// push the excess of closure node a along admissible arcs, relabel it if
+	// excess remains
+	void discharge(std::size_t a);
+
+	// recompute exact distance labels with a breadth-first search from the
+	// sink, nodes that can not reach the sink get _infinite_label
+	void global_relabel();
+
+	// call f(b, flow, forward) for each arc a->b of the residual graph of
+	// closure node a: forward arcs have infinite capacity and flow over them
+	// is added to *flow, backward arcs have the capacity *flow
+	template <typename F>
+	void for_each_residual_arc(std::size_t a, F f);
+
+	// call f(a) for each closure node a with an arc a->b of positive
+	// capacity in the residual graph
+	template <typename F>
+	void for_each_residual_predecessor(std::size_t b, F f) const;
+
+	// the closure node for the indicator [h[n] >= l], 0 < l < num_levels
+	std::size_t closure_node(NodeId n, int l) const { return n*(_num_levels - 1) + (l - 1); }
+
+	// whether the indicator [h[n] >= l] is not fixed
+	bool is_variable(NodeId n, int l) const { return l > _min_levels[n] && l <= _max_levels[n]; }
+
+	// whether level l of column n has to be excluded by an arc to the closure
+	// node of level l+1
+	bool is_hole(NodeId n, int l) const { return _has_holes && std::isinf(_level_costs(n, l)); }
+
+	GridTopology _topology;
+
+	int _num_levels;
+
+	LevelCosts _level_costs;
+
+	// for each node, bit j is set if the neighbor in direction j exists,
+	// where direction 2i is offset i of the topology and 2i+1 the opposite
+	std::vector<std::uint32_t> _neighbors;
+	std::vector<std::ptrdiff_t> _direction_strides;
+	std::vector<int> _direction_gradients;
+	int _num_directions;
+
+	// the range of levels of each column after the presolve
+	std::vector<int> _min_levels;
+	std::vector<int> _max_levels;
+
+	// whether there are levels with infinite costs inside the ranges
+	bool _has_holes;
+
+	// excess of each closure node if positive, residual capacity of the arc
+	// to the sink if negative
+	std::vector<double> _excess;
+
+	std::vector<int> _label;
+	int _infinite_label;
+
+	// the flow over the arcs of each closure node to the closure node below,
+	// above (for holes), and in each direction
+	std::vector<double> _down_flow;
+	std::vector<double> _up_flow;
+	std::vector<double> _direction_flow;
+
+	std::deque<std::size_t> _active;
+	std::vector<bool> _queued;
+
+	std::size_t _work_since_global_relabel;
+
+	IlpSolver::Statistics _statistics;
+
+	std::vector<int> _levels;
+};
+
+#endif // PYSURFREC_SURFREC_GRID_SURFACE_SOLVER_H__
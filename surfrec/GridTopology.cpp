@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <util/exceptions.h>
+#include "GridTopology.h"
+
+GridTopology::GridTopology(
+		const std::vector<std::size_t>& shape,
+		int connectivity,
+		const std::vector<int>& max_gradients,
+		const std::vector<bool>& wrap_around) :
+	_shape(shape),
+	_strides(shape.size()),
+	_wrap_around(shape.size(), false),
+	_num_nodes(1) {
+
+	const std::size_t dims = shape.size();
+
+	if (dims == 0)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"the grid needs at least one dimension");
+
+	if (max_gradients.size() != 1 && max_gradients.size() != dims)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"expected one max gradient, or one per axis (" << dims << "), got " << max_gradients.size());
+
+	if (wrap_around.size() > 1 && wrap_around.size() != dims)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"expected one wrap-around flag, or one per axis (" << dims << "), got " << wrap_around.size());
+
+	for (std::size_t d = 0; d < dims && !wrap_around.empty(); d++)
+		_wrap_around[d] = wrap_around[wrap_around.size() == 1 ? 0 : d] && shape[d] >= 3;
+
+	int num_face_neighbors = 2*dims;
+	int num_full_neighbors = 1;
+	for (std::size_t d = 0; d < dims; d++)
+		num_full_neighbors *= 3;
+	num_full_neighbors -= 1;
+
+	if (connectivity != num_face_neighbors && connectivity != num_full_neighbors)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"connectivity for a " << dims << "D grid has to be " << num_face_neighbors
+				<< " or " << num_full_neighbors << ", got " << connectivity);
+
+	bool full = (connectivity == num_full_neighbors && connectivity != num_face_neighbors);
+
+	std::ptrdiff_t stride = 1;
+	for (std::size_t d = dims; d-- > 0;) {
+
+		_strides[d] = stride;
+		stride *= shape[d];
+	}
+	_num_nodes = stride;
+
+	// enumerate all offsets in {-1,0,1}^dims, keep the ones whose first
+	// non-zero entry is positive to visit each edge only once
+	std::vector<int> delta(dims, -1);
+	while (true) {
+
+		int num_nonzero = 0;
+		int first_nonzero = 0;
+		for (std::size_t d = 0; d < dims; d++)
+			if (delta[d] != 0) {
+
+				if (num_nonzero == 0)
+					first_nonzero = delta[d];
+				num_nonzero++;
+			}
+
+		if (first_nonzero > 0 && (full || num_nonzero == 1)) {
+
+			Offset offset;
+			offset.delta = delta;
+			offset.stride = 0;
+			offset.max_gradient = 0;
+
+			for (std::size_t d = 0; d < dims; d++) {
+
+				offset.stride += delta[d]*_strides[d];
+
+				if (delta[d] != 0)
+					offset.max_gradient = std::max(
+							offset.max_gradient,
+							max_gradients[max_gradients.size() == 1 ? 0 : d]);
+			}
+
+			_offsets.push_back(offset);
+		}
+
+		// next offset
+		std::size_t d = dims;
+		while (d > 0 && delta[d-1] == 1) {
+
+			delta[d-1] = -1;
+			d--;
+		}
+		if (d == 0)
+			break;
+		delta[d-1]++;
+	}
+}
+
+std::size_t
+GridTopology::num_edges() const {
+
+	std::size_t num_edges = 0;
+
+	for (const Offset& offset : _offsets) {
+
+		std::size_t n = 1;
+		for (std::size_t d = 0; d < _shape.size(); d++)
+			if (offset.delta[d] == 0 || _wrap_around[d])
+				n *= _shape[d];
+			else
+				n *= (_shape[d] > 0 ? _shape[d] - 1 : 0);
+
+		num_edges += n;
+	}
+
+	return num_edges;
+}
@@ -0,0 +1,168 @@
+#ifndef PYSURFREC_SURFREC_GRID_TOPOLOGY_H__
+#define PYSURFREC_SURFREC_GRID_TOPOLOGY_H__
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * The neighborhood structure of a regular N-dimensional lattice. Nodes are
+ * enumerated in C order (the last axis varies fastest). Edges are never
+ * stored, instead they are generated on the fly from a fixed set of neighbor
+ * offsets.
+ */
+class GridTopology {
+
+public:
+
+	typedef std::size_t NodeId;
+
+	/**
+	 * Create a new grid topology.
+	 *
+	 * @param shape
+	 *              The size of the grid along each axis.
+	 * @param connectivity
+	 *              The number of neighbors of a node inside the grid. Either
+	 *              2N (only direct neighbors along the axes, e.g., 4 in 2D and
+	 *              6 in 3D) or 3^N-1 (all neighbors in the surrounding cube,
+	 *              e.g., 8 in 2D and 26 in 3D).
+	 * @param max_gradients
+	 *              The maximal gradient of the surface along each axis. A
+	 *              single value is used for all axes. Diagonal neighbors use
+	 *              the largest gradient of the axes they span.
+	 * @param wrap_around
+	 *              For each axis, whether the first and last nodes along the
+	 *              axis are neighbors (periodic boundary). A single value is
+	 *              used for all axes, an empty vector disables wrap-around.
+	 *              Axes with less than three nodes never wrap around, since
+	 *              this would only duplicate edges.
+	 */
+	GridTopology(
+			const std::vector<std::size_t>& shape,
+			int connectivity,
+			const std::vector<int>& max_gradients,
+			const std::vector<bool>& wrap_around = std::vector<bool>());
+
+	/**
+	 * The number of nodes in the grid.
+	 */
+	std::size_t num_nodes() const { return _num_nodes; }
+
+	/**
+	 * The number of edges in the grid.
+	 */
+	std::size_t num_edges() const;
+
+	/**
+	 * The number of neighbor offsets per node, counting each edge only once
+	 * (i.e., half the connectivity).
+	 */
+	std::size_t num_offsets() const { return _offsets.size(); }
+
+	/**
+	 * The difference of the node ids of the two nodes of the edges with
+	 * offset i (v - u for edges (u, v) that do not wrap around).
+	 */
+	std::ptrdiff_t offset_stride(std::size_t i) const { return _offsets[i].stride; }
+
+	/**
+	 * The max gradient of the edges with offset i.
+	 */
+	int offset_max_gradient(std::size_t i) const { return _offsets[i].max_gradient; }
+
+	/**
+	 * Call f(u, v, max_gradient) for each edge of the grid.
+	 */
+	template <typename F>
+	void for_each_edge(F f) const;
+
+	/**
+	 * Call f(u, v, i) for each edge of the grid, where i is the index of the
+	 * offset of the edge.
+	 */
+	template <typename F>
+	void for_each_offset_edge(F f) const;
+
+private:
+
+	struct Offset {
+
+		// the offset along each axis, one of -1, 0, 1
+		std::vector<int> delta;
+
+		// the difference of the node ids of the two nodes of the edge
+		std::ptrdiff_t stride;
+
+		int max_gradient;
+	};
+
+	std::vector<std::size_t> _shape;
+
+	// strides of the axes in C order
+	std::vector<std::ptrdiff_t> _strides;
+
+	std::vector<bool> _wrap_around;
+
+	std::size_t _num_nodes;
+
+	std::vector<Offset> _offsets;
+};
+
+template <typename F>
+void
+GridTopology::for_each_edge(F f) const {
+
+	for_each_offset_edge([&](NodeId u, NodeId v, std::size_t i) {
+
+		f(u, v, _offsets[i].max_gradient);
+	});
+}
+
+template <typename F>
+void
+GridTopology::for_each_offset_edge(F f) const {
+
+	const std::size_t dims = _shape.size();
+
+	if (_num_nodes == 0)
+		return;
+
+	// the coordinates of the current node
+	std::vector<std::size_t> coords(dims, 0);
+
+	for (NodeId u = 0; u < _num_nodes; u++) {
+
+		for (std::size_t i = 0; i < _offsets.size(); i++) {
+
+			const Offset& offset = _offsets[i];
+			NodeId v = u + offset.stride;
+
+			bool inside = true;
+			for (std::size_t d = 0; d < dims && inside; d++) {
+
+				bool outside =
+						(offset.delta[d] < 0 && coords[d] == 0) ||
+						(offset.delta[d] > 0 && coords[d] + 1 == _shape[d]);
+
+				// continue on the other side of the grid
+				if (outside && _wrap_around[d])
+					v -= offset.delta[d]*static_cast<std::ptrdiff_t>(_shape[d])*_strides[d];
+				else
+					inside = !outside;
+			}
+
+			if (inside)
+				f(u, v, i);
+		}
+
+		// advance the coordinates in C order
+		for (std::size_t d = dims; d-- > 0;) {
+
+			if (++coords[d] < _shape[d])
+				break;
+			coords[d] = 0;
+		}
+	}
+}
+
+#endif // PYSURFREC_SURFREC_GRID_TOPOLOGY_H__
@@ -1,20 +1,297 @@
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <limits>
+#include <thread>
+#include <tuple>
+#include "GridTopology.h"
 #include "IlpSolver.h"
+#include "MaxFlow.h"
+#include "ParallelMaxFlow.h"
+#include <solver/LinearConstraintSink.h>
 #include <solver/SolverFactory.h>
 #include <util/Logger.h>
 #include <util/helpers.hpp>
 
 logger::LogChannel ilpsolverlog("ilpsolverlog", "[IlpSolver] ");
 
-IlpSolver::IlpSolver(std::size_t num_nodes, std::size_t num_edges, int num_levels, int max_gradient) :
-	_level_costs(_graph),
+namespace {
+
+/**
+ * Logs all constraints passed to another sink on the All level.
+ */
+class LoggingSink : public LinearConstraintSink {
+
+public:
+
+	LoggingSink(LinearConstraintSink& sink) : _sink(sink) {}
+
+	void addConstraints(const LinearConstraints& batch) override {
+
+		for (auto c : batch)
+			LOG_ALL(ilpsolverlog) << c << std::endl;
+
+		_sink.addConstraints(batch);
+	}
+
+private:
+
+	LinearConstraintSink& _sink;
+};
+
+/**
+ * Passes only the constraints that are violated by a solution on to another
+ * sink. Constraints are identified by their position in the stream, such
+ * that a constraint that was passed on in an earlier round (with the same
+ * order of constraints) is not passed on again, even if the solution
+ * violates it within the tolerance of the solver.
+ */
+class ViolatedConstraintFilter : public LinearConstraintSink {
+
+public:
+
+	ViolatedConstraintFilter(LinearConstraintSink& sink, const Solution& solution, double tolerance, std::vector<bool>& passed) :
+		_sink(sink),
+		_solution(solution),
+		_tolerance(tolerance),
+		_passed(passed),
+		_next(0),
+		_num_violated(0) {}
+
+	void addConstraints(const LinearConstraints& batch) override {
+
+		_violated.clear();
+
+		for (auto c : batch) {
+
+			std::size_t i = _next++;
+
+			if (i >= _passed.size())
+				_passed.resize(i + 1, false);
+
+			if (_passed[i] || !c.isViolated(_solution, _tolerance))
+				continue;
+
+			_passed[i] = true;
+
+			LinearConstraints::Builder violated = _violated.emplace(c.getRelation(), c.getValue());
+			for (std::size_t i = 0; i < c.size(); i++)
+				violated.setCoefficient(c.getVarNum(i), c.getCoefficient(i));
+		}
+
+		_sink.addConstraints(_violated);
+		_num_violated += _violated.size();
+	}
+
+	std::size_t num_violated() const { return _num_violated; }
+
+private:
+
+	LinearConstraintSink& _sink;
+	const Solution& _solution;
+	double _tolerance;
+
+	// whether the constraint at each position was passed on before
+	std::vector<bool>& _passed;
+	std::size_t _next;
+
+	LinearConstraints _violated;
+	std::size_t _num_violated;
+};
+
+/**
+ * Checks whether all constraints passed to another sink are difference
+ * constraints (a single variable with coefficient 1, or two variables with
+ * coefficients 1 and -1) with an integral right hand side.
+ */
+class DifferenceConstraintCheck : public LinearConstraintSink {
+
+public:
+
+	DifferenceConstraintCheck(LinearConstraintSink& sink) :
+		_sink(sink),
+		_all_difference_constraints(true) {}
+
+	void addConstraints(const LinearConstraints& batch) override {
+
+		for (auto c : batch) {
+
+			if (!_all_difference_constraints)
+				break;
+
+			bool is_difference =
+					c.getValue() == std::round(c.getValue()) &&
+					((c.size() == 1 && c.getCoefficient(0) == 1) ||
+					 (c.size() == 2 && c.getCoefficient(0) == -c.getCoefficient(1) && std::fabs(c.getCoefficient(0)) == 1));
+
+			if (!is_difference)
+				_all_difference_constraints = false;
+		}
+
+		_sink.addConstraints(batch);
+	}
+
+	bool all_difference_constraints() const { return _all_difference_constraints; }
+
+private:
+
+	LinearConstraintSink& _sink;
+	bool _all_difference_constraints;
+};
+
+/**
+ * Call f(begin, end, thread) for num_threads contiguous ranges [begin,end)
+ * that partition 0,...,num_items-1, each in its own thread.
+ */
+template <typename F>
+void
+parallel_for(std::size_t num_items, int num_threads, const F& f) {
+
+	num_threads = std::max(num_threads, 1);
+
+	auto range = [&](int thread) {
+
+		std::size_t begin = num_items*thread/num_threads;
+		std::size_t end   = num_items*(thread + 1)/num_threads;
+
+		f(begin, end, thread);
+	};
+
+	if (num_threads == 1) {
+
+		range(0);
+		return;
+	}
+
+	std::vector<std::thread> threads;
+	for (int t = 1; t < num_threads; t++)
+		threads.push_back(std::thread(range, t));
+	range(0);
+	for (std::thread& thread : threads)
+		thread.join();
+}
+
+/**
+ * Generate the constraints of items 0,...,num_items-1 with generate(slice, i)
+ * in parallel. In each round, every thread generates the constraints of a
+ * contiguous range of items into its own slice, which is reserved for
+ * rows_per_item constraints with coefs_per_row coefficients per item. The
+ * slices are passed to the stream in order, such that the order of the
+ * constraints does not depend on the number of threads.
+ */
+template <typename Generator>
+void
+generate_constraints(
+		std::size_t num_items,
+		std::size_t rows_per_item,
+		std::size_t coefs_per_row,
+		int num_threads,
+		LinearConstraintStream& constraints,
+		const Generator& generate) {
+
+	num_threads = std::max(num_threads, 1);
+
+	// about one batch of the stream per thread and round
+	std::size_t items_per_thread = std::max(constraints.getBatchSize()/std::max(rows_per_item, std::size_t(1)), std::size_t(1));
+	std::size_t items_per_round  = items_per_thread*num_threads;
+
+	std::vector<LinearConstraints> slices(num_threads);
+	for (LinearConstraints& slice : slices)
+		slice.reserve(
+				std::min(items_per_thread, num_items)*rows_per_item,
+				std::min(items_per_thread, num_items)*rows_per_item*coefs_per_row);
+
+	for (std::size_t first = 0; first < num_items; first += items_per_round) {
+
+		std::size_t num_round_items = std::min(items_per_round, num_items - first);
+
+		parallel_for(num_round_items, num_threads, [&](std::size_t begin, std::size_t end, int thread) {
+
+			slices[thread].clear();
+			for (std::size_t i = first + begin; i < first + end; i++)
+				generate(slices[thread], i);
+		});
+
+		for (const LinearConstraints& slice : slices)
+			if (slice.size() > 0)
+				constraints.add(slice);
+	}
+}
+
+/**
+ * Compute out[i] = min { in[j] : |i-j| <= radius } for arrays of the given
+ * size in O(size), independent of the radius (van Herk, Gil and Werman).
+ * The input is padded with infinity and split into blocks of 2*radius+1
+ * values, such that each window consists of a suffix of one block and a
+ * prefix of the next one. The final loop over the windows is branch-free,
+ * such that it can be vectorized by the compiler.
+ */
+void
+min_filter(
+		const double* in,
+		double*       out,
+		int           size,
+		int           radius,
+		std::vector<double>& prefix,
+		std::vector<double>& suffix) {
+
+	const double infinity = std::numeric_limits<double>::infinity();
+
+	if (radius <= 0) {
+
+		std::copy(in, in + size, out);
+		return;
+	}
+
+	if (radius >= size - 1) {
+
+		std::fill(out, out + size, *std::min_element(in, in + size));
+		return;
+	}
+
+	const int block = 2*radius + 1;
+	const int padded_size = ((size + 2*radius + block - 1)/block)*block;
+
+	prefix.assign(padded_size, infinity);
+	suffix.assign(padded_size, infinity);
+	std::copy(in, in + size, prefix.begin() + radius);
+	std::copy(in, in + size, suffix.begin() + radius);
+
+	for (int begin = 0; begin < padded_size; begin += block) {
+
+		for (int j = begin + 1; j < begin + block; j++)
+			prefix[j] = std::min(prefix[j], prefix[j-1]);
+		for (int j = begin + block - 2; j >= begin; j--)
+			suffix[j] = std::min(suffix[j], suffix[j+1]);
+	}
+
+	const double* s = &suffix[0];
+	const double* p = &prefix[2*radius];
+	for (int i = 0; i < size; i++)
+		out[i] = std::min(s[i], p[i]);
+}
+
+} // anonymous namespace
+
+IlpSolver::IlpSolver(
+		std::size_t num_nodes,
+		std::size_t num_edges,
+		int num_levels,
+		int max_gradient,
+		bool single_precision_costs) :
+	_level_costs(num_levels, single_precision_costs),
 	_max_gradients(_graph),
+	_penalty_ids(_graph),
 	_num_nodes(0),
 	_num_edges(0),
 	_num_levels(num_levels),
-	_max_gradient(max_gradient) {
+	_max_gradient(max_gradient),
+	_objective_offset(0),
+	_integral_lp(false) {
 
 	_graph.reserveNode(num_nodes);
 	_graph.reserveEdge(num_edges);
+	_level_costs.reserve(num_nodes);
 }
 
 IlpSolver::NodeId
@@ -25,7 +302,12 @@ IlpSolver::add_nodes(std::size_t num_nodes) {
 				UsageError,
 				"at least one node has to be added with a call to add_nodes");
 
+	discard_models();
+
 	_num_nodes += num_nodes;
+	_level_costs.resize(_num_nodes);
+	_first_levels.resize(_num_nodes, 0);
+	_last_levels.resize(_num_nodes, _num_levels - 1);
 
 	NodeId first = _graph.id(_graph.addNode());
 	num_nodes--;
@@ -44,15 +326,212 @@ IlpSolver::add_edge(NodeId u, NodeId v) {
 void
 IlpSolver::add_edge(NodeId u, NodeId v, int g) {
 
+	if (u >= _num_nodes || v >= _num_nodes)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"can not add edge (" << u << ", " << v << "), there are only " << _num_nodes << " nodes");
+
+	if (g < 0)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"the max gradient of edge (" << u << ", " << v << ") is negative");
+
+	discard_models();
+
 	GraphType::Edge e = _graph.addEdge(_graph.nodeFromId(u), _graph.nodeFromId(v));
 	_max_gradients[e] = g;
+	_penalty_ids[e] = -1;
 	_num_edges++;
 }
 
+void
+IlpSolver::add_edge(NodeId u, NodeId v, int g, std::size_t penalty) {
+
+	if (penalty >= _penalties.size())
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"penalty " << penalty << " does not exist, there are only " << _penalties.size() << " penalties");
+
+	add_edge(u, v, g);
+
+	// edges are never removed, the new edge has the largest id
+	_penalty_ids[_graph.edgeFromId(_num_edges - 1)] = penalty;
+}
+
+void
+IlpSolver::add_grid_edges(
+		const std::vector<std::size_t>& shape,
+		int connectivity,
+		const std::vector<int>& max_gradients,
+		const std::vector<bool>& wrap_around) {
+
+	GridTopology grid(shape, connectivity, max_gradients, wrap_around);
+
+	if (grid.num_nodes() != _num_nodes)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"the grid has " << grid.num_nodes() << " nodes, but " << _num_nodes << " nodes were added");
+
+	std::size_t num_edges = grid.num_edges();
+
+	LOG_DEBUG(ilpsolverlog) << "adding " << num_edges << " grid edges" << std::endl;
+
+	discard_models();
+
+	_graph.reserveEdge(_num_edges + num_edges);
+
+	// node ids are valid by construction, add the edges directly
+	grid.for_each_edge([&](NodeId u, NodeId v, int g) {
+
+		GraphType::Edge e = _graph.addEdge(_graph.nodeFromId(u), _graph.nodeFromId(v));
+		_max_gradients[e] = g;
+		_penalty_ids[e] = -1;
+	});
+
+	_num_edges += num_edges;
+}
+
+void
+IlpSolver::add_grid_edges(
+		const std::vector<std::size_t>& shape,
+		int connectivity,
+		const std::vector<int>& max_gradients,
+		const std::vector<bool>& wrap_around,
+		std::size_t penalty) {
+
+	if (penalty >= _penalties.size())
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"penalty " << penalty << " does not exist, there are only " << _penalties.size() << " penalties");
+
+	std::size_t first = _num_edges;
+
+	add_grid_edges(shape, connectivity, max_gradients, wrap_around);
+
+	for (std::size_t i = first; i < _num_edges; i++)
+		_penalty_ids[_graph.edgeFromId(i)] = penalty;
+}
+
+std::size_t
+IlpSolver::add_penalty(const std::vector<double>& costs) {
+
+	if (costs.empty())
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"the costs of a penalty need at least one value");
+
+	for (std::size_t d = 0; d < costs.size(); d++) {
+
+		if (!std::isfinite(costs[d]))
+			UTIL_THROW_EXCEPTION(
+					UsageError,
+					"the costs of a penalty have to be finite, got " << costs[d] << " for a difference of " << d);
+
+		if (d > 0 && costs[d] < costs[d - 1])
+			UTIL_THROW_EXCEPTION(
+					UsageError,
+					"the costs of a penalty have to be non-decreasing, got " << costs[d] <<
+					" for a difference of " << d << " after " << costs[d - 1]);
+
+		if (d > 1 && costs[d] - costs[d - 1] < costs[d - 1] - costs[d - 2])
+			UTIL_THROW_EXCEPTION(
+					UsageError,
+					"the costs of a penalty have to be convex, but the slope decreases at a difference of " << d - 1);
+	}
+
+	discard_models();
+
+	_penalties.push_back(costs);
+
+	return _penalties.size() - 1;
+}
+
+void
+IlpSolver::reserve_edges(std::size_t num_edges) {
+
+	_graph.reserveEdge(num_edges);
+}
+
+void
+IlpSolver::add_separation(NodeId lower, NodeId upper, int min_separation, int max_separation) {
+
+	if (lower >= _num_nodes || upper >= _num_nodes)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"can not add separation (" << lower << ", " << upper << "), there are only " << _num_nodes << " nodes");
+
+	if (lower == upper)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"can not add a separation between node " << lower << " and itself");
+
+	if (min_separation > max_separation)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"the min separation " << min_separation << " of (" << lower << ", " << upper << ") "
+				"is larger than the max separation " << max_separation);
+
+	Separation separation;
+	separation.lower = lower;
+	separation.upper = upper;
+	separation.min_separation = min_separation;
+	separation.max_separation = max_separation;
+
+	discard_models();
+
+	_separations.push_back(separation);
+}
+
 void
 IlpSolver::set_level_costs(NodeId n, const std::vector<double>& costs) {
 
-	_level_costs[_graph.nodeFromId(n)] = costs;
+	// unlike update_level_costs(), the change is not tracked for resolve()
+	discard_models();
+
+	_level_costs.set(n, costs);
+}
+
+void
+IlpSolver::set_level_range(NodeId n, int first_level, int last_level) {
+
+	if (n >= _num_nodes)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"node " << n << " does not exist, there are only " << _num_nodes << " nodes");
+
+	if (first_level < 0 || first_level > last_level || last_level >= _num_levels)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"invalid level range [" << first_level << ", " << last_level << "] for node " << n <<
+				", levels have to be between 0 and " << _num_levels - 1);
+
+	discard_models();
+
+	_first_levels[n] = first_level;
+	_last_levels[n]  = last_level;
+}
+
+void
+IlpSolver::discard_models() {
+
+	_solver.reset();
+	_flow.reset();
+	_contracted.reset();
+	_changed_nodes.clear();
+}
+
+bool
+IlpSolver::has_feasible_surface() const {
+
+	Parameters parameters;
+	parameters.presolve = true;
+
+	// the propagation finds all infeasible problems
+	std::vector<int> min_levels;
+	std::vector<int> max_levels;
+	NodeId infeasible_node;
+
+	return narrow_level_ranges(parameters, min_levels, max_levels, infeasible_node);
 }
 
 double
@@ -64,195 +543,2002 @@ IlpSolver::min_surface() {
 double
 IlpSolver::min_surface(const Parameters& parameters) {
 
-	std::size_t num_vars = _num_nodes*_num_levels;
-
-	LOG_DEBUG(ilpsolverlog) << "creating objective for " << num_vars << " binary variables" << std::endl;
-	LinearObjective objective(num_vars);
+	return min_surface(parameters, std::vector<int>());
+}
 
-	LOG_DEBUG(ilpsolverlog) << "setting objective coefficients" << std::endl;
-	for (GraphType::NodeIt n(_graph); n != lemon::INVALID; ++n) {
+double
+IlpSolver::min_surface(const Parameters& parameters, const std::vector<int>& initial_levels) {
 
-		double sum = 0;
+	if (!initial_levels.empty()) {
 
-		for (int l = 0; l < _num_levels; l++) {
+		if (initial_levels.size() != _num_nodes)
+			UTIL_THROW_EXCEPTION(
+					UsageError,
+					"expected initial levels for " << _num_nodes << " nodes, got " << initial_levels.size());
 
-			std::size_t var_num = _graph.id(n)*_num_levels + l;
-			double costs = _level_costs[n][l];
-			double accumulated_costs = costs - sum;
-			sum += accumulated_costs;
+		for (NodeId n = 0; n < _num_nodes; n++)
+			if (initial_levels[n] < 0 || initial_levels[n] >= _num_levels)
+				UTIL_THROW_EXCEPTION(
+						UsageError,
+						"invalid initial level " << initial_levels[n] << " for node " << n);
 
-			objective.setCoefficient(var_num, accumulated_costs);
-		}
+		if (parameters.engine != Ilp)
+			LOG_DEBUG(ilpsolverlog) << "initial levels are only used by the Ilp engine" << std::endl;
 	}
 
-	LinearConstraints constraints;
+	_parameters = parameters;
+	_changed_nodes.clear();
+	_statistics = Statistics();
+	_statistics.engine = parameters.engine;
+
+	// the zero-minimum constraints depend on the neighborhoods of the
+	// original nodes
+	if (parameters.contract_zero_gradient_edges && !parameters.enforce_zero_minimum && contract_zero_gradient_edges())
+		return min_surface_contracted(parameters, initial_levels);
 
-	// pick at least lowest level
-	LOG_DEBUG(ilpsolverlog) << "adding indicator constraints" << std::endl;
-	for (GraphType::NodeIt n(_graph); n != lemon::INVALID; ++n) {
+	_contracted.reset();
 
-		std::size_t var_num = _graph.id(n)*_num_levels;
+	switch (parameters.engine) {
 
-		LinearConstraint indicator;
-		indicator.setCoefficient(var_num, 1.0);
-		indicator.setRelation(Equal);
-		indicator.setValue(1.0);
-		constraints.add(indicator);
+		case MinCut:
+			return min_surface_min_cut(parameters);
+
+		case DynamicProgramming:
+			return min_surface_dp(parameters);
+
+		default:
+			return min_surface_ilp(parameters, initial_levels);
 	}
+}
 
-	// column inclusion constraints
-	LOG_DEBUG(ilpsolverlog) << "adding column inclusion constraints" << std::endl;
-	for (GraphType::NodeIt n(_graph); n != lemon::INVALID; ++n) {
+bool
+IlpSolver::contract_zero_gradient_edges() {
 
-		for (int l = 1; l < _num_levels; l++) {
+	// union-find over the nodes, joined by zero-gradient edges
+	std::vector<NodeId> parents(_num_nodes);
+	for (NodeId n = 0; n < _num_nodes; n++)
+		parents[n] = n;
 
-			std::size_t upper_var_num = _graph.id(n)*_num_levels + l;
-			std::size_t lower_var_num = _graph.id(n)*_num_levels + l - 1;
+	auto find = [&parents](NodeId n) {
 
-			LinearConstraint inclusion;
-			inclusion.setCoefficient(upper_var_num,  1.0);
-			inclusion.setCoefficient(lower_var_num, -1.0);
-			inclusion.setRelation(LessEqual);
-			inclusion.setValue(0.0);
+		while (parents[n] != n) {
 
-			constraints.add(inclusion);
+			parents[n] = parents[parents[n]];
+			n = parents[n];
 		}
-	}
+		return n;
+	};
 
-	// gradient constraints
-	LOG_DEBUG(ilpsolverlog) << "adding gradient constraints" << std::endl;
+	bool contracted = false;
 	for (GraphType::EdgeIt e(_graph); e != lemon::INVALID; ++e) {
 
-		GraphType::Node u = _graph.u(e);
-		GraphType::Node v = _graph.v(e);
+		if (_max_gradients[e] != 0)
+			continue;
+
+		NodeId u = find(_graph.id(_graph.u(e)));
+		NodeId v = find(_graph.id(_graph.v(e)));
 
-		for (auto& p : { std::make_pair(u, v), std::make_pair(v, u) }) {
+		if (u == v)
+			continue;
 
-			GraphType::Node u_ = p.first;
-			GraphType::Node v_ = p.second;
+		// the smaller id becomes the root, such that the numbering of the
+		// super nodes below follows the node ids
+		if (u < v)
+			parents[v] = u;
+		else
+			parents[u] = v;
 
-			for (int l = _max_gradients[e]; l < _num_levels; l++) {
+		contracted = true;
+	}
 
-				std::size_t upper_var_num = _graph.id(u_)*_num_levels + l;
-				std::size_t lower_var_num = _graph.id(v_)*_num_levels + l - _max_gradients[e];
+	if (!contracted)
+		return false;
 
-				LinearConstraint inclusion;
-				inclusion.setCoefficient(upper_var_num,  1.0);
-				inclusion.setCoefficient(lower_var_num, -1.0);
-				inclusion.setRelation(LessEqual);
-				inclusion.setValue(0.0);
+	// number the super nodes in the order of their smallest node
+	_super_nodes.resize(_num_nodes);
+	std::size_t num_super_nodes = 0;
+	for (NodeId n = 0; n < _num_nodes; n++) {
 
-				constraints.add(inclusion);
-			}
-		}
+		NodeId root = find(n);
+		_super_nodes[n] = (root == n ? num_super_nodes++ : _super_nodes[root]);
 	}
 
-	if (parameters.enforce_zero_minimum) {
+	LOG_DEBUG(ilpsolverlog)
+			<< "contracted " << _num_nodes << " nodes into " << num_super_nodes
+			<< " super nodes along zero-gradient edges" << std::endl;
 
-		LOG_USER(ilpsolverlog) << "enforcing minima of zero" << std::endl;
+	// the edges between super nodes, parallel edges are merged into the one
+	// with the smallest max gradient, except for penalized edges, which are
+	// kept as they are (within a super node as loops, which add the costs
+	// of a difference of zero)
+	std::vector<std::tuple<NodeId, NodeId, int>> edges;
+	std::vector<std::tuple<NodeId, NodeId, int, int>> penalized_edges;
+	for (GraphType::EdgeIt e(_graph); e != lemon::INVALID; ++e) {
 
-		if (parameters.num_neighbors < 0)
-			UTIL_THROW_EXCEPTION(
-					UsageError,
-					"if 'enforce_zero_minimum' is set, 'num_neighbors' has to be set, too.");
+		NodeId u = _super_nodes[_graph.id(_graph.u(e))];
+		NodeId v = _super_nodes[_graph.id(_graph.v(e))];
 
-		// for each indicator between 1 and _num_levels - 1: if top indicator t 
-		// is 0, one of the neighbors n ∈ N must be zero, too:
-		//
-		//   t=0 ⇒ Σn<|N|
-		//
-		//   Σn - t ≤ |N| - 1 if t=0, one of neighbors has to be 0
-		//                    if t=1, constraint always true
+		if (_penalty_ids[e] >= 0) {
 
-		for (GraphType::NodeIt n(_graph); n != lemon::INVALID; ++n) {
+			penalized_edges.push_back(std::make_tuple(u, v, _max_gradients[e], _penalty_ids[e]));
+			continue;
+		}
 
-			for (int l = 1; l < _num_levels - 1; l++) {
+		if (u == v)
+			continue;
 
-				LinearConstraint zero_minimum;
+		edges.push_back(std::make_tuple(std::min(u, v), std::max(u, v), _max_gradients[e]));
+	}
+	std::sort(edges.begin(), edges.end());
+	edges.erase(
+			std::unique(
+					edges.begin(),
+					edges.end(),
+					[](const std::tuple<NodeId, NodeId, int>& a, const std::tuple<NodeId, NodeId, int>& b) {
+						return std::get<0>(a) == std::get<0>(b) && std::get<1>(a) == std::get<1>(b);
+					}),
+			edges.end());
+
+	_contracted.reset(new IlpSolver(num_super_nodes, edges.size() + penalized_edges.size(), _num_levels, _max_gradient, _level_costs.single_precision()));
+	_contracted->add_nodes(num_super_nodes);
+	for (const auto& edge : edges)
+		_contracted->add_edge(std::get<0>(edge), std::get<1>(edge), std::get<2>(edge));
+
+	// the penalties keep their ids
+	for (const std::vector<double>& costs : _penalties)
+		_contracted->add_penalty(costs);
+	for (const auto& edge : penalized_edges)
+		_contracted->add_edge(std::get<0>(edge), std::get<1>(edge), std::get<2>(edge), std::get<3>(edge));
+
+	// separations within a super node are either always or never satisfied
+	for (const Separation& separation : _separations) {
+
+		NodeId lower = _super_nodes[separation.lower];
+		NodeId upper = _super_nodes[separation.upper];
+
+		if (lower != upper)
+			_contracted->add_separation(lower, upper, separation.min_separation, separation.max_separation);
+		else if (separation.min_separation > 0 || separation.max_separation < 0)
+			UTIL_THROW_EXCEPTION(
+					Exception,
+					"nodes " << separation.lower << " and " << separation.upper << " are joined by "
+					"zero-gradient edges, but their separation has to be between " <<
+					separation.min_separation << " and " << separation.max_separation);
+	}
 
-				// Σn
-				for (GraphType::IncEdgeIt e(_graph, n); e != lemon::INVALID; ++e) {
+	// the costs of a super node are the sums of the costs of its nodes
+	std::vector<double> costs(num_super_nodes*_num_levels, 0.0);
+	for (NodeId n = 0; n < _num_nodes; n++)
+		for (int l = 0; l < _num_levels; l++)
+			costs[_super_nodes[n]*_num_levels + l] += _level_costs(n, l);
+	_contracted->set_level_costs(0, num_super_nodes, costs.data(), _num_levels*sizeof(double), sizeof(double));
 
-					GraphType::Node nb = _graph.oppositeNode(n, e);
-					std::size_t nb_var_num = _graph.id(nb)*_num_levels + l;
-					zero_minimum.setCoefficient(nb_var_num, 1.0);
-				}
+	// a super node can only take the levels allowed for all of its nodes
+	std::vector<int> first_levels(num_super_nodes, 0);
+	std::vector<int> last_levels(num_super_nodes, _num_levels - 1);
+	for (NodeId n = 0; n < _num_nodes; n++) {
 
-				// -t
-				std::size_t t_var_num = _graph.id(n)*_num_levels + l + 1;
-				zero_minimum.setCoefficient(t_var_num, -1.0);
+		first_levels[_super_nodes[n]] = std::max(first_levels[_super_nodes[n]], _first_levels[n]);
+		last_levels[_super_nodes[n]]  = std::min(last_levels[_super_nodes[n]], _last_levels[n]);
+	}
 
-				// ≤ |N| - 1
-				zero_minimum.setRelation(LessEqual);
-				zero_minimum.setValue(parameters.num_neighbors - 1);
+	for (NodeId n = 0; n < num_super_nodes; n++) {
 
-				constraints.add(zero_minimum);
-			}
-		}
+		if (first_levels[n] > last_levels[n])
+			UTIL_THROW_EXCEPTION(
+					Exception,
+					"the level ranges of nodes joined by zero-gradient edges do not overlap");
+
+		if (first_levels[n] > 0 || last_levels[n] < _num_levels - 1)
+			_contracted->set_level_range(n, first_levels[n], last_levels[n]);
 	}
 
-	SolverFactory factory;
-	_solver = std::unique_ptr<LinearSolverBackend>(factory.createLinearSolverBackend());
+	_statistics.num_contracted_nodes = _num_nodes - num_super_nodes;
 
-	LOG_DEBUG(ilpsolverlog) << "initialize solver" << std::endl;
-	if (parameters.solve_relaxed_problem) {
+	return true;
+}
 
-		_solver->initialize(num_vars, Continuous);
-		// we have to force values to be within 0 and 1
-		for (std::size_t i = 0; i < num_vars; i++) {
-			LinearConstraint lower_bound, upper_bound;
-			lower_bound.setCoefficient(i, 1.0);
-			lower_bound.setRelation(GreaterEqual);
-			lower_bound.setValue(0.0);
-			upper_bound.setCoefficient(i, 1.0);
-			upper_bound.setRelation(LessEqual);
-			upper_bound.setValue(1.0);
-			constraints.add(lower_bound);
-			constraints.add(upper_bound);
-		}
+double
+IlpSolver::min_surface_contracted(const Parameters& parameters, const std::vector<int>& initial_levels) {
 
-	} else {
+	_solver.reset();
+	_flow.reset();
 
-		_solver->initialize(num_vars, Binary);
+	std::vector<int> initial_super_levels;
+	if (!initial_levels.empty()) {
+
+		// take the initial level of the first node of each super node
+		initial_super_levels.assign(_contracted->num_nodes(), -1);
+		for (NodeId n = 0; n < _num_nodes; n++)
+			if (initial_super_levels[_super_nodes[n]] < 0)
+				initial_super_levels[_super_nodes[n]] = initial_levels[n];
 	}
-	LOG_DEBUG(ilpsolverlog) << "setting objective" << std::endl;
-	_solver->setObjective(objective);
-	LOG_DEBUG(ilpsolverlog) << "setting setting constraints" << std::endl;
-	_solver->setConstraints(constraints);
 
-	LOG_ALL(ilpsolverlog) << objective << std::endl;
-	for (auto c : constraints)
-		LOG_ALL(ilpsolverlog) << c << std::endl;
+	double value = _contracted->min_surface(parameters, initial_super_levels);
 
-	LinearSolverBackend::Parameters solverParameters;
-	solverParameters.numThreads = parameters.num_threads;
-	solverParameters.verbose    = parameters.verbose;
+	read_contracted_levels();
 
-	LOG_DEBUG(ilpsolverlog) << "solving" << std::endl;
-	std::string message;
-	if (!_solver->solve(_solution, message, solverParameters))
-		UTIL_THROW_EXCEPTION(
-				LinearSolverBackendException,
-				"linear program could not be solved: " << message);
+	return value;
+}
+
+void
+IlpSolver::read_contracted_levels() {
+
+	const std::vector<int>& super_levels = _contracted->levels();
 
-	LOG_ALL(ilpsolverlog) << _solution.getVector() << std::endl;
+	_levels.resize(_num_nodes);
+	for (NodeId n = 0; n < _num_nodes; n++)
+		_levels[n] = super_levels[_super_nodes[n]];
 
-	return _solution.getValue();
+	std::size_t num_contracted_nodes = _statistics.num_contracted_nodes;
+	_statistics = _contracted->statistics();
+	_statistics.num_contracted_nodes = num_contracted_nodes;
 }
 
-int
-IlpSolver::level(NodeId n) {
+double
+IlpSolver::min_surface_ilp(const Parameters& parameters, const std::vector<int>& initial_levels) {
 
-	std::size_t lowest_var_num = n*_num_levels;
+	_flow.reset();
+	_initial_levels = initial_levels;
 
-	if (_solution[lowest_var_num] < 0.5)
+	if (parameters.enforce_zero_minimum && parameters.num_neighbors < 0)
 		UTIL_THROW_EXCEPTION(
-				Exception,
-				"no level was selected for node " << n);
+				UsageError,
+				"if 'enforce_zero_minimum' is set, 'num_neighbors' has to be set, too.");
+
+	if (parameters.formulation == Heights) {
+
+		if (parameters.enforce_zero_minimum)
+			UTIL_THROW_EXCEPTION(
+					UsageError,
+					"'enforce_zero_minimum' is not supported by the Heights formulation");
+
+		find_level_ranges(parameters, _min_levels, _max_levels);
+		find_breakpoints();
+		build_height_ilp(parameters);
+
+		if (!initial_levels.empty()) {
+
+			LOG_DEBUG(ilpsolverlog) << "setting initial solution" << std::endl;
+			_solver->setInitialSolution(heights(initial_levels));
+		}
 
-	for (int l = 1; l < _num_levels; l++)
-		if (_solution[lowest_var_num + l] < 0.5)
-			return l-1;
+		return solve_ilp();
+	}
+
+	bool integral_lp =
+			parameters.detect_integral_lp &&
+			!parameters.solve_relaxed_problem &&
+			is_difference_system(parameters);
+
+	if (integral_lp)
+		LOG_DEBUG(ilpsolverlog) << "constraints are totally unimodular, solving as LP" << std::endl;
+
+	find_level_ranges(parameters, _min_levels, _max_levels);
+
+	if (!build_ilp(parameters, integral_lp)) {
+
+		LOG_USER(ilpsolverlog) << "found constraints that are not difference constraints, solving as ILP" << std::endl;
+		build_ilp(parameters, false);
+	}
+
+	// the LP is solved without branching, a start would not help
+	if (!initial_levels.empty() && !_integral_lp) {
+
+		LOG_DEBUG(ilpsolverlog) << "setting initial solution" << std::endl;
+		_solver->setInitialSolution(indicators(initial_levels));
+	}
+
+	return solve_ilp();
+}
+
+Solution
+IlpSolver::indicators(const std::vector<int>& levels) const {
+
+	// x[n,l] = 1 for all levels l up to and including the level of n
+	Solution solution(_statistics.num_variables);
+
+	for (NodeId n = 0; n < _num_nodes; n++)
+		for (int l = _min_levels[n] + 1; l <= _max_levels[n]; l++)
+			solution[var_num(n, l)] = (l <= levels[n] ? 1.0 : 0.0);
+
+	set_penalty_variables(levels, solution);
+
+	return solution;
+}
+
+double
+IlpSolver::objective_offset() const {
+
+	// the accumulated costs of the fixed indicators x[n,0],...,x[n,min] sum
+	// up to the costs of level min, or of the last level below with finite
+	// costs (see LevelCosts::accumulated())
+	double offset = 0;
+	for (NodeId n = 0; n < _num_nodes; n++)
+		for (int l = _min_levels[n]; l >= 0; l--)
+			if (!std::isinf(_level_costs(n, l))) {
+
+				offset += _level_costs(n, l);
+				break;
+			}
+
+	// penalized loops always have a difference of zero
+	for (GraphType::EdgeIt e(_graph); e != lemon::INVALID; ++e)
+		if (_penalty_ids[e] >= 0 && _graph.u(e) == _graph.v(e))
+			offset += penalty(_penalty_ids[e], 0);
+
+	return offset;
+}
+
+double
+IlpSolver::penalty_costs(const std::vector<int>& levels) const {
+
+	double costs = 0;
+	for (GraphType::EdgeIt e(_graph); e != lemon::INVALID; ++e)
+		if (_penalty_ids[e] >= 0)
+			costs += penalty(
+					_penalty_ids[e],
+					std::abs(levels[_graph.id(_graph.u(e))] - levels[_graph.id(_graph.v(e))]));
+
+	return costs;
+}
+
+std::size_t
+IlpSolver::number_penalty_variables(std::size_t first) {
+
+	_penalty_var_nums.assign(_num_edges, static_cast<std::size_t>(-1));
+
+	std::size_t num_penalty_vars = 0;
+	for (GraphType::EdgeIt e(_graph); e != lemon::INVALID; ++e)
+		if (_penalty_ids[e] >= 0 && _graph.u(e) != _graph.v(e))
+			_penalty_var_nums[_graph.id(e)] = first + num_penalty_vars++;
+
+	return num_penalty_vars;
+}
+
+void
+IlpSolver::set_penalty_bounds(std::vector<double>& lower_bounds, std::vector<double>& upper_bounds) const {
+
+	// the costs of a difference of zero, up to the costs of the largest
+	// possible difference
+	for (GraphType::EdgeIt e(_graph); e != lemon::INVALID; ++e) {
+
+		std::size_t t = _penalty_var_nums[_graph.id(e)];
+
+		if (t == static_cast<std::size_t>(-1))
+			continue;
+
+		NodeId u = _graph.id(_graph.u(e));
+		NodeId v = _graph.id(_graph.v(e));
+
+		lower_bounds[t] = penalty(_penalty_ids[e], 0);
+		upper_bounds[t] = penalty(_penalty_ids[e], max_difference(u, v, _max_gradients[e]));
+	}
+}
+
+void
+IlpSolver::set_penalty_variables(const std::vector<int>& levels, Solution& solution) const {
+
+	// the levels are clipped to the ranges, as for the other variables
+	auto level = [&](GraphType::Node node) {
+
+		NodeId n = _graph.id(node);
+		return std::min(std::max(levels[n], _min_levels[n]), _max_levels[n]);
+	};
+
+	for (GraphType::EdgeIt e(_graph); e != lemon::INVALID; ++e) {
+
+		std::size_t t = _penalty_var_nums[_graph.id(e)];
+
+		if (t != static_cast<std::size_t>(-1))
+			solution[t] = penalty(_penalty_ids[e], std::abs(level(_graph.u(e)) - level(_graph.v(e))));
+	}
+}
+
+void
+IlpSolver::find_level_ranges(
+		const Parameters& parameters,
+		std::vector<int>& min_levels,
+		std::vector<int>& max_levels) const {
+
+	NodeId n;
+	if (narrow_level_ranges(parameters, min_levels, max_levels, n))
+		return;
+
+	bool all_infinite = true;
+	for (int l = _first_levels[n]; l <= _last_levels[n]; l++)
+		if (!std::isinf(_level_costs(n, l)))
+			all_infinite = false;
+
+	if (all_infinite)
+		UTIL_THROW_EXCEPTION(
+				Exception,
+				"all levels of node " << n << " have infinite costs");
+
+	UTIL_THROW_EXCEPTION(
+			Exception,
+			"there is no surface that satisfies the gradient and separation constraints at node " << n);
+}
+
+bool
+IlpSolver::narrow_level_ranges(
+		const Parameters& parameters,
+		std::vector<int>& min_levels,
+		std::vector<int>& max_levels,
+		NodeId& infeasible_node) const {
+
+	min_levels = _first_levels;
+	max_levels = _last_levels;
+
+	// infeasible constraints would result in an infinite flow, the MinCut
+	// engine relies on the propagation below to detect them
+	if (!parameters.presolve && parameters.engine != MinCut)
+		return true;
+
+	// levels with infinite costs at the bottom or top of a column can not be
+	// selected
+	for (NodeId n = 0; n < _num_nodes; n++) {
+
+		while (min_levels[n] <= max_levels[n] && std::isinf(_level_costs(n, min_levels[n])))
+			min_levels[n]++;
+		while (max_levels[n] >= min_levels[n] && std::isinf(_level_costs(n, max_levels[n])))
+			max_levels[n]--;
+
+		if (min_levels[n] > max_levels[n]) {
+
+			infeasible_node = n;
+			return false;
+		}
+	}
+
+	// the separations of each node u as (v, lo, hi) with lo <= h[v] - h[u]
+	// <= hi, in compressed form
+	std::vector<std::size_t> first_separation(_num_nodes + 1, 0);
+	for (const Separation& separation : _separations) {
+
+		first_separation[separation.lower + 1]++;
+		first_separation[separation.upper + 1]++;
+	}
+	for (NodeId n = 0; n < _num_nodes; n++)
+		first_separation[n + 1] += first_separation[n];
+
+	std::vector<std::tuple<NodeId, int, int>> separations(2*_separations.size());
+	std::vector<std::size_t> next_separation(first_separation.begin(), first_separation.end() - 1);
+	for (const Separation& separation : _separations) {
+
+		separations[next_separation[separation.lower]++] =
+				std::make_tuple(separation.upper, separation.min_separation, separation.max_separation);
+		separations[next_separation[separation.upper]++] =
+				std::make_tuple(separation.lower, -separation.max_separation, -separation.min_separation);
+	}
+
+	// without zero-minimum constraints, the level of a node without neighbors
+	// only depends on its own costs
+	if (!parameters.enforce_zero_minimum) {
+
+		for (GraphType::NodeIt node(_graph); node != lemon::INVALID; ++node) {
+
+			NodeId n = _graph.id(node);
+
+			if (GraphType::IncEdgeIt(_graph, node) != lemon::INVALID || first_separation[n] < first_separation[n + 1])
+				continue;
+
+			int best = min_levels[n];
+			for (int l = min_levels[n] + 1; l <= max_levels[n]; l++)
+				if (_level_costs(n, l) < _level_costs(n, best))
+					best = l;
+
+			min_levels[n] = max_levels[n] = best;
+		}
+	}
+
+	// make the ranges arc-consistent with the gradient constraints |h_u -
+	// h_v| <= g and the separation constraints lo <= h_v - h_u <= hi, i.e.,
+	// min_levels[v] >= min_levels[u] + lo and max_levels[v] <=
+	// max_levels[u] + hi (with lo = -g and hi = g for edges)
+	std::deque<NodeId> queue;
+	std::vector<bool> queued(_num_nodes, true);
+	for (NodeId n = 0; n < _num_nodes; n++)
+		queue.push_back(n);
+
+	// levels with infinite costs inside the ranges are skipped whenever a
+	// bound moves, which makes the propagation detect all infeasible
+	// problems (the constraints are implications between the indicators,
+	// and the bounds are the indicators forced to 1 and 0)
+	bool feasible = true;
+	auto propagate = [&](NodeId u, NodeId v, int lo, int hi) {
+
+		bool changed = false;
+		if (min_levels[v] < min_levels[u] + lo) {
+
+			min_levels[v] = min_levels[u] + lo;
+			while (min_levels[v] <= max_levels[v] && std::isinf(_level_costs(v, min_levels[v])))
+				min_levels[v]++;
+			changed = true;
+		}
+		if (max_levels[v] > max_levels[u] + hi) {
+
+			max_levels[v] = max_levels[u] + hi;
+			while (max_levels[v] >= min_levels[v] && std::isinf(_level_costs(v, max_levels[v])))
+				max_levels[v]--;
+			changed = true;
+		}
+
+		if (min_levels[v] > max_levels[v]) {
+
+			infeasible_node = v;
+			feasible = false;
+			return;
+		}
+
+		if (changed && !queued[v]) {
+
+			queue.push_back(v);
+			queued[v] = true;
+		}
+	};
+
+	while (feasible && !queue.empty()) {
+
+		NodeId u = queue.front();
+		queue.pop_front();
+		queued[u] = false;
+
+		GraphType::Node node = _graph.nodeFromId(u);
+		for (GraphType::IncEdgeIt e(_graph, node); feasible && e != lemon::INVALID; ++e)
+			propagate(u, _graph.id(_graph.oppositeNode(node, e)), -_max_gradients[e], _max_gradients[e]);
+
+		for (std::size_t i = first_separation[u]; feasible && i < first_separation[u + 1]; i++)
+			propagate(u, std::get<0>(separations[i]), std::get<1>(separations[i]), std::get<2>(separations[i]));
+	}
+
+	return feasible;
+}
+
+bool
+IlpSolver::build_ilp(const Parameters& parameters, bool integral_lp) {
+
+	// only the indicators x[n,l] with _min_levels[n] < l <= _max_levels[n] are
+	// variables, the ones below are 1, the ones above 0
+	_first_var_nums.resize(_num_nodes + 1);
+	_first_var_nums[0] = 0;
+	for (NodeId n = 0; n < _num_nodes; n++)
+		_first_var_nums[n + 1] = _first_var_nums[n] + (_max_levels[n] - _min_levels[n]);
+
+	std::size_t num_indicators = _first_var_nums.back();
+
+	LOG_DEBUG(ilpsolverlog)
+			<< "fixed " << (_num_nodes*_num_levels - num_indicators) << " of "
+			<< (_num_nodes*_num_levels) << " indicators" << std::endl;
+
+	// the costs of the penalized edges follow the indicators
+	std::size_t num_penalty_vars = number_penalty_variables(num_indicators);
+	std::size_t num_vars = num_indicators + num_penalty_vars;
+
+	SolverFactory factory;
+	_solver = std::unique_ptr<LinearSolverBackend>(factory.createLinearSolverBackend());
+	_lazy_constraints_added.clear();
+	_integral_lp = integral_lp;
+
+	LOG_DEBUG(ilpsolverlog) << "initialize solver" << std::endl;
+	if (num_penalty_vars > 0) {
+
+		std::map<unsigned int, VariableType> special_types;
+		std::vector<double> lower_bounds(num_vars, 0.0);
+		std::vector<double> upper_bounds(num_vars, 1.0);
+
+		if (!parameters.solve_relaxed_problem && !integral_lp)
+			for (std::size_t i = 0; i < num_indicators; i++)
+				special_types[i] = Binary;
+
+		set_penalty_bounds(lower_bounds, upper_bounds);
+
+		_solver->initialize(num_vars, Continuous, special_types, lower_bounds, upper_bounds);
+
+	} else if (parameters.solve_relaxed_problem || integral_lp) {
+
+		// we have to force values to be within 0 and 1
+		_solver->initialize(
+				num_vars,
+				Continuous,
+				std::map<unsigned int, VariableType>(),
+				std::vector<double>(num_vars, 0.0),
+				std::vector<double>(num_vars, 1.0));
+
+	} else {
+
+		_solver->initialize(num_vars, Binary);
+	}
+
+	{
+		LOG_DEBUG(ilpsolverlog) << "creating objective for " << num_indicators << " binary variables" << std::endl;
+		LinearObjective objective(num_vars);
+
+		LOG_DEBUG(ilpsolverlog) << "setting objective coefficients" << std::endl;
+		parallel_for(_num_nodes, parameters.num_threads, [&](std::size_t begin, std::size_t end, int) {
+
+			for (NodeId n = begin; n < end; n++)
+				for (int l = _min_levels[n] + 1; l <= _max_levels[n]; l++)
+					objective.setCoefficient(var_num(n, l), _level_costs.accumulated(n, l));
+		});
+
+		for (std::size_t i = num_indicators; i < num_vars; i++)
+			objective.setCoefficient(i, 1.0);
+
+		// the costs of the fixed indicators
+		_objective_offset = objective_offset();
+
+		LOG_DEBUG(ilpsolverlog) << "setting objective" << std::endl;
+		_solver->setObjective(objective);
+
+		LOG_ALL(ilpsolverlog) << objective << std::endl;
+	}
+
+	// pass the constraints to the solver in batches while they are generated,
+	// such that they are never all in memory twice
+	LOG_DEBUG(ilpsolverlog) << "setting constraints" << std::endl;
+	LinearSolverBackendSink backend_sink(*_solver);
+	DifferenceConstraintCheck check(backend_sink);
+	LoggingSink sink(check);
+	LinearConstraintStream constraints(sink);
+
+	add_column_constraints(parameters, constraints);
+	std::size_t num_column_constraints = constraints.size();
+	add_penalty_constraints(parameters, constraints);
+	std::size_t num_penalty_constraints = constraints.size() - num_column_constraints;
+	if (!parameters.lazy_constraints)
+		add_surface_constraints(parameters, constraints);
+	constraints.flush();
+
+	LOG_DEBUG(ilpsolverlog) << "added " << constraints.size() << " constraints" << std::endl;
+
+	_statistics.num_variables   = num_vars;
+	_statistics.num_constraints = constraints.size();
+
+	// compare to the formulation with all indicators as variables
+	std::size_t num_full_constraints = _num_nodes*_num_levels + num_penalty_constraints;
+	if (!parameters.lazy_constraints) {
+
+		for (GraphType::EdgeIt e(_graph); e != lemon::INVALID; ++e)
+			num_full_constraints += 2*std::max(_num_levels - _max_gradients[e], 0);
+		for (const Separation& separation : _separations)
+			num_full_constraints +=
+					std::max(_num_levels - std::max(-separation.min_separation, 0), 0) +
+					std::max(_num_levels - std::max(separation.max_separation, 0), 0);
+		if (parameters.enforce_zero_minimum)
+			num_full_constraints += _num_nodes*std::max(_num_levels - 2, 0);
+	}
+
+	_statistics.num_removed_variables   = _num_nodes*_num_levels - num_indicators;
+	_statistics.num_removed_constraints = num_full_constraints - std::min(num_full_constraints, constraints.size());
+
+	// the integrality of the LP relies on the constraints being difference
+	// constraints, make sure we did not add others
+	return !integral_lp || check.all_difference_constraints();
+}
+
+bool
+IlpSolver::is_difference_system(const Parameters& parameters) const {
+
+	// Without the zero-minimum constraints, every row either bounds a single
+	// indicator or is a difference constraint x[u,k] - x[v,l] <= 0 with an
+	// integral right hand side. The constraint matrix is then the
+	// transpose of a network matrix and totally unimodular, such that the LP
+	// relaxation has an integral optimal vertex. This does not hold for the
+	// rows of the penalties, which sum up the indicators of two columns.
+	if (parameters.enforce_zero_minimum)
+		return false;
+
+	for (GraphType::EdgeIt e(_graph); e != lemon::INVALID; ++e)
+		if (_penalty_ids[e] >= 0 && _graph.u(e) != _graph.v(e))
+			return false;
+
+	return true;
+}
+
+void
+IlpSolver::add_column_constraints(const Parameters& parameters, LinearConstraintStream& constraints) {
+
+	// The lowest indicator x[n,0] (at least the lowest level is picked) is
+	// fixed to 1 and not a variable.
+
+	// column inclusion constraints
+	LOG_DEBUG(ilpsolverlog) << "adding column inclusion constraints" << std::endl;
+	generate_constraints(_num_nodes, _num_levels - 1, 2, parameters.num_threads, constraints, [&](LinearConstraints& slice, NodeId n) {
+
+		for (int l = _min_levels[n] + 2; l <= _max_levels[n]; l++)
+			slice.emplace(LessEqual, 0.0)
+					.setCoefficient(var_num(n, l),      1.0)
+					.setCoefficient(var_num(n, l - 1), -1.0);
+
+		// levels with infinite costs can not be the level of n: x[n,l] ⇒
+		// x[n,l+1] (with presolve, these are never at the ends of the range)
+		for (int l = _min_levels[n]; l <= _max_levels[n]; l++)
+			if (std::isinf(_level_costs(n, l)))
+				add_implication(slice, n, l, n, l + 1);
+	});
+}
+
+void
+IlpSolver::add_implication(
+		LinearConstraints& constraints,
+		NodeId u, int k,
+		NodeId v, int l) const {
+
+	// x[u,k] <= x[v,l]
+	int upper = indicator(u, k);
+	int lower = indicator(v, l);
+
+	if (upper == 0 || lower == 1)
+		return;
+
+	if (upper == 1 && lower == 0) {
+
+		// can not be satisfied
+		constraints.emplace(LessEqual, -1.0);
+		return;
+	}
+
+	if (upper == 1)
+		constraints.emplace(GreaterEqual, 1.0).setCoefficient(var_num(v, l), 1.0);
+	else if (lower == 0)
+		constraints.emplace(LessEqual, 0.0).setCoefficient(var_num(u, k), 1.0);
+	else
+		constraints.emplace(LessEqual, 0.0)
+				.setCoefficient(var_num(u, k),  1.0)
+				.setCoefficient(var_num(v, l), -1.0);
+}
+
+void
+IlpSolver::add_difference_implications(
+		LinearConstraints& constraints,
+		NodeId u, NodeId v, int d) const {
+
+	// x[u,l] is 0 above the range of u, x[v,l-d] is 1 below the range of v
+	// (and for l-d <= 0), x[u,0] is always 1
+	for (int l = std::max(0, _min_levels[v] + d + 1); l <= _max_levels[u]; l++)
+		add_implication(constraints, u, l, v, l - d);
+}
+
+void
+IlpSolver::add_surface_constraints(const Parameters& parameters, LinearConstraintStream& constraints) {
+
+	const int num_threads = parameters.num_threads;
+
+	// gradient constraints, edges are visited in the order of their ids
+	LOG_DEBUG(ilpsolverlog) << "adding gradient constraints" << std::endl;
+	generate_constraints(_num_edges, 2*_num_levels, 2, num_threads, constraints, [&](LinearConstraints& slice, std::size_t i) {
+
+		GraphType::Edge e = _graph.edgeFromId(i);
+		NodeId u = _graph.id(_graph.u(e));
+		NodeId v = _graph.id(_graph.v(e));
+		int g = _max_gradients[e];
+
+		// h[u] - h[v] <= g and h[v] - h[u] <= g
+		add_difference_implications(slice, u, v, g);
+		add_difference_implications(slice, v, u, g);
+	});
+
+	if (!_separations.empty()) {
+
+		LOG_DEBUG(ilpsolverlog) << "adding separation constraints" << std::endl;
+		generate_constraints(_separations.size(), 2*_num_levels, 2, num_threads, constraints, [&](LinearConstraints& slice, std::size_t i) {
+
+			const Separation& separation = _separations[i];
+
+			// h[lower] - h[upper] <= -min and h[upper] - h[lower] <= max
+			add_difference_implications(slice, separation.lower, separation.upper, -separation.min_separation);
+			add_difference_implications(slice, separation.upper, separation.lower, separation.max_separation);
+		});
+	}
+
+	if (parameters.enforce_zero_minimum) {
+
+		LOG_USER(ilpsolverlog) << "enforcing minima of zero" << std::endl;
+
+		// for each indicator between 1 and _num_levels - 1: if top indicator t 
+		// is 0, one of the neighbors n ∈ N must be zero, too:
+		//
+		//   t=0 ⇒ Σn<|N|
+		//
+		//   Σn - t ≤ |N| - 1 if t=0, one of neighbors has to be 0
+		//                    if t=1, constraint always true
+
+		generate_constraints(_num_nodes, std::max(_num_levels - 2, 0), parameters.num_neighbors + 1, num_threads, constraints, [&](LinearConstraints& slice, NodeId i) {
+
+			GraphType::Node n = _graph.nodeFromId(i);
+
+			for (int l = 1; l < _num_levels - 1; l++) {
+
+				// ≤ |N| - 1, minus the fixed indicators
+				double value = parameters.num_neighbors - 1;
+
+				int t = indicator(i, l + 1);
+				if (t == 1)
+					continue;
+
+				bool has_variables = (t < 0);
+				for (GraphType::IncEdgeIt e(_graph, n); e != lemon::INVALID; ++e) {
+
+					int nb = indicator(_graph.id(_graph.oppositeNode(n, e)), l);
+					if (nb == 1)
+						value -= 1;
+					if (nb < 0)
+						has_variables = true;
+				}
+
+				// always satisfied
+				if (!has_variables && value >= 0)
+					continue;
+
+				LinearConstraints::Builder zero_minimum =
+						slice.emplace(LessEqual, value);
+
+				// Σn
+				for (GraphType::IncEdgeIt e(_graph, n); e != lemon::INVALID; ++e) {
+
+					NodeId nb = _graph.id(_graph.oppositeNode(n, e));
+					if (indicator(nb, l) < 0)
+						zero_minimum.setCoefficient(var_num(nb, l), 1.0);
+				}
+
+				// -t
+				if (t < 0)
+					zero_minimum.setCoefficient(var_num(i, l + 1), -1.0);
+			}
+		});
+	}
+}
+
+void
+IlpSolver::add_penalty_constraints(const Parameters& parameters, LinearConstraintStream& constraints) {
+
+	if (_penalties.empty())
+		return;
+
+	const bool heights = (parameters.formulation == Heights);
+
+	// a row sums up the indicators of two columns, unless the heights are
+	// variables
+	std::size_t coefs_per_row = (heights ? 3 : 2*(_first_var_nums.back()/std::max(_num_nodes, std::size_t(1))) + 1);
+
+	LOG_DEBUG(ilpsolverlog) << "adding penalty constraints" << std::endl;
+	generate_constraints(_num_edges, 2, coefs_per_row, parameters.num_threads, constraints, [&](LinearConstraints& slice, std::size_t i) {
+
+		std::size_t t = _penalty_var_nums[i];
+
+		if (t == static_cast<std::size_t>(-1))
+			return;
+
+		GraphType::Edge e = _graph.edgeFromId(i);
+		NodeId u = _graph.id(_graph.u(e));
+		NodeId v = _graph.id(_graph.v(e));
+		std::size_t p = _penalty_ids[e];
+
+		// The penalty f(|d|) of the difference d = h[a] - h[b] is the
+		// maximum of f(0) (the lower bound of t) and the lines through the
+		// costs of k and k+1 for both signs of d:
+		//
+		//   t - s_k*(h[a] - h[b]) >= f(k) - s_k*k,  s_k = f(k+1) - f(k)
+		//
+		// Pieces with a slope of zero or the slope of the previous piece add
+		// nothing, as do pieces beyond the largest possible difference.
+		int num_pieces = max_difference(u, v, _max_gradients[e]);
+		double previous_slope = 0;
+
+		for (int k = 0; k < num_pieces; k++) {
+
+			double slope = penalty(p, k + 1) - penalty(p, k);
+
+			if (slope <= previous_slope)
+				continue;
+			previous_slope = slope;
+
+			for (auto& pair : { std::make_pair(u, v), std::make_pair(v, u) }) {
+
+				NodeId a = pair.first;
+				NodeId b = pair.second;
+
+				if (_max_levels[a] - _min_levels[b] <= k)
+					continue;
+
+				double value = penalty(p, k) - slope*k;
+
+				if (heights) {
+
+					slice.emplace(GreaterEqual, value)
+							.setCoefficient(t,  1.0)
+							.setCoefficient(a, -slope)
+							.setCoefficient(b,  slope);
+
+				} else {
+
+					// h[n] = min + Σ_l x[n,l]
+					LinearConstraints::Builder row =
+							slice.emplace(GreaterEqual, value + slope*(_min_levels[a] - _min_levels[b]));
+					row.setCoefficient(t, 1.0);
+					for (int l = _min_levels[a] + 1; l <= _max_levels[a]; l++)
+						row.setCoefficient(var_num(a, l), -slope);
+					for (int l = _min_levels[b] + 1; l <= _max_levels[b]; l++)
+						row.setCoefficient(var_num(b, l), slope);
+				}
+			}
+		}
+	});
+}
+
+void
+IlpSolver::find_breakpoints() {
+
+	_first_breakpoints.resize(_num_nodes + 1);
+	_first_breakpoints[0] = 0;
+	_breakpoints.clear();
+
+	for (NodeId n = 0; n < _num_nodes; n++) {
+
+		for (int l = _min_levels[n]; l <= _max_levels[n]; l++)
+			if (std::isinf(_level_costs(n, l)))
+				UTIL_THROW_EXCEPTION(
+						Exception,
+						"level " << l << " of node " << n << " has infinite costs, which the Heights "
+						"formulation does not support (set 'presolve' to exclude infinite costs at "
+						"the bottom and top of the columns)");
+
+		// the lowest and highest level, and every level where the slope of
+		// the costs changes
+		_breakpoints.push_back(_min_levels[n]);
+		for (int l = _min_levels[n] + 1; l < _max_levels[n]; l++)
+			if (_level_costs(n, l + 1) - _level_costs(n, l) != _level_costs(n, l) - _level_costs(n, l - 1))
+				_breakpoints.push_back(l);
+		if (_max_levels[n] > _min_levels[n])
+			_breakpoints.push_back(_max_levels[n]);
+
+		_first_breakpoints[n + 1] = _breakpoints.size();
+	}
+
+	LOG_DEBUG(ilpsolverlog)
+			<< "found " << (_breakpoints.size() - _num_nodes) << " segments of linear costs in "
+			<< _num_nodes << " columns" << std::endl;
+}
+
+bool
+IlpSolver::is_concave_breakpoint(NodeId n, std::size_t k) const {
+
+	if (k == 0)
+		return false;
+
+	const int* breakpoints = &_breakpoints[_first_breakpoints[n]];
+
+	// compare the slopes without dividing by the lengths of the segments
+	return
+			segment_costs(n, k)*(breakpoints[k] - breakpoints[k - 1]) <
+			segment_costs(n, k - 1)*(breakpoints[k + 1] - breakpoints[k]);
+}
+
+void
+IlpSolver::build_height_ilp(const Parameters& parameters) {
+
+	// the heights h[n] are followed by the segment fractions d[n,k] of all
+	// nodes, and the binary variables z[n,k] for each concave breakpoint k
+	std::size_t num_segments = _breakpoints.size() - _num_nodes;
+
+	_first_order_var_nums.resize(_num_nodes + 1);
+	_first_order_var_nums[0] = _num_nodes + num_segments;
+	for (NodeId n = 0; n < _num_nodes; n++) {
+
+		std::size_t num_breakpoints = _first_breakpoints[n + 1] - _first_breakpoints[n];
+		std::size_t num_concave = 0;
+		for (std::size_t k = 1; k + 1 < num_breakpoints; k++)
+			if (is_concave_breakpoint(n, k))
+				num_concave++;
+
+		_first_order_var_nums[n + 1] = _first_order_var_nums[n] + num_concave;
+	}
+
+	// the costs of the penalized edges follow the binary variables
+	std::size_t num_order_vars   = _first_order_var_nums.back() - _first_order_var_nums[0];
+	std::size_t num_penalty_vars = number_penalty_variables(_first_order_var_nums.back());
+	std::size_t num_vars = _first_order_var_nums.back() + num_penalty_vars;
+
+	LOG_DEBUG(ilpsolverlog)
+			<< "creating " << _num_nodes << " height variables, " << num_segments << " segment variables, "
+			<< num_order_vars << " binary variables, and " << num_penalty_vars << " penalty variables" << std::endl;
+
+	SolverFactory factory;
+	_solver = std::unique_ptr<LinearSolverBackend>(factory.createLinearSolverBackend());
+	_lazy_constraints_added.clear();
+	_integral_lp = false;
+
+	std::map<unsigned int, VariableType> special_types;
+	std::vector<double> lower_bounds(num_vars, 0.0);
+	std::vector<double> upper_bounds(num_vars, 1.0);
+
+	for (NodeId n = 0; n < _num_nodes; n++) {
+
+		lower_bounds[n] = _min_levels[n];
+		upper_bounds[n] = _max_levels[n];
+	}
+
+	set_penalty_bounds(lower_bounds, upper_bounds);
+
+	if (!parameters.solve_relaxed_problem) {
+
+		for (NodeId n = 0; n < _num_nodes; n++)
+			special_types[n] = Integer;
+		for (std::size_t i = _first_order_var_nums[0]; i < _first_order_var_nums.back(); i++)
+			special_types[i] = Binary;
+	}
+
+	LOG_DEBUG(ilpsolverlog) << "initialize solver" << std::endl;
+	_solver->initialize(num_vars, Continuous, special_types, lower_bounds, upper_bounds);
+
+	{
+		LinearObjective objective(num_vars);
+
+		// the costs of a node are the costs of its lowest level plus the
+		// costs of the filled fractions of its segments
+		parallel_for(_num_nodes, parameters.num_threads, [&](std::size_t begin, std::size_t end, int) {
+
+			for (NodeId n = begin; n < end; n++)
+				for (std::size_t k = 0; k + 1 < _first_breakpoints[n + 1] - _first_breakpoints[n]; k++)
+					objective.setCoefficient(segment_var_num(n, k), segment_costs(n, k));
+		});
+
+		for (std::size_t i = _first_order_var_nums.back(); i < num_vars; i++)
+			objective.setCoefficient(i, 1.0);
+
+		_objective_offset = objective_offset();
+
+		LOG_DEBUG(ilpsolverlog) << "setting objective" << std::endl;
+		_solver->setObjective(objective);
+
+		LOG_ALL(ilpsolverlog) << objective << std::endl;
+	}
+
+	LOG_DEBUG(ilpsolverlog) << "setting constraints" << std::endl;
+	LinearSolverBackendSink backend_sink(*_solver);
+	LoggingSink sink(backend_sink);
+	LinearConstraintStream constraints(sink);
+
+	add_segment_constraints(parameters, constraints);
+	add_penalty_constraints(parameters, constraints);
+	if (!parameters.lazy_constraints)
+		add_height_gradient_constraints(parameters, constraints);
+	constraints.flush();
+
+	LOG_DEBUG(ilpsolverlog) << "added " << constraints.size() << " constraints" << std::endl;
+
+	_statistics.num_variables   = num_vars;
+	_statistics.num_constraints = constraints.size();
+}
+
+void
+IlpSolver::add_segment_constraints(const Parameters& parameters, LinearConstraintStream& constraints) {
+
+	LOG_DEBUG(ilpsolverlog) << "adding segment constraints" << std::endl;
+	generate_constraints(_num_nodes, 3, 4, parameters.num_threads, constraints, [&](LinearConstraints& slice, NodeId n) {
+
+		const int* breakpoints = &_breakpoints[_first_breakpoints[n]];
+		std::size_t num_segments = _first_breakpoints[n + 1] - _first_breakpoints[n] - 1;
+
+		// the height is fixed by its bounds
+		if (num_segments == 0)
+			return;
+
+		// h[n] - Σ_k len_k*d[n,k] = min
+		LinearConstraints::Builder height = slice.emplace(Equal, breakpoints[0]);
+		height.setCoefficient(n, 1.0);
+		for (std::size_t k = 0; k < num_segments; k++)
+			height.setCoefficient(segment_var_num(n, k), -(breakpoints[k + 1] - breakpoints[k]));
+
+		// Within a run of segments with increasing slopes, the segments are
+		// filled in order without further constraints, since the first ones
+		// are the cheapest. A run after a concave breakpoint can only be
+		// entered (z=1) if all segments of the previous run are filled:
+		//
+		//   d[n,j] <= z  for all segments j of the run
+		//   z <= d[n,j]  for all segments j of the previous run
+		std::size_t run_begin = 0;
+		std::size_t z = _first_order_var_nums[n];
+
+		for (std::size_t k = 1; k < num_segments; k++) {
+
+			if (!is_concave_breakpoint(n, k))
+				continue;
+
+			std::size_t run_end = k + 1;
+			while (run_end < num_segments && !is_concave_breakpoint(n, run_end))
+				run_end++;
+
+			for (std::size_t j = run_begin; j < k; j++)
+				slice.emplace(LessEqual, 0.0)
+						.setCoefficient(z, 1.0)
+						.setCoefficient(segment_var_num(n, j), -1.0);
+			for (std::size_t j = k; j < run_end; j++)
+				slice.emplace(LessEqual, 0.0)
+						.setCoefficient(segment_var_num(n, j), 1.0)
+						.setCoefficient(z, -1.0);
+
+			run_begin = k;
+			z++;
+		}
+	});
+}
+
+void
+IlpSolver::add_height_gradient_constraints(const Parameters& parameters, LinearConstraintStream& constraints) {
+
+	LOG_DEBUG(ilpsolverlog) << "adding gradient constraints" << std::endl;
+	generate_constraints(_num_edges, 2, 2, parameters.num_threads, constraints, [&](LinearConstraints& slice, std::size_t i) {
+
+		GraphType::Edge e = _graph.edgeFromId(i);
+		NodeId u = _graph.id(_graph.u(e));
+		NodeId v = _graph.id(_graph.v(e));
+		int g = _max_gradients[e];
+
+		if (u == v)
+			return;
+
+		// h[u] - h[v] <= g, unless implied by the bounds of the heights
+		for (auto& p : { std::make_pair(u, v), std::make_pair(v, u) })
+			if (_max_levels[p.first] - _min_levels[p.second] > g)
+				slice.emplace(LessEqual, g)
+						.setCoefficient(p.first,   1.0)
+						.setCoefficient(p.second, -1.0);
+	});
+
+	if (_separations.empty())
+		return;
+
+	LOG_DEBUG(ilpsolverlog) << "adding separation constraints" << std::endl;
+	generate_constraints(_separations.size(), 2, 2, parameters.num_threads, constraints, [&](LinearConstraints& slice, std::size_t i) {
+
+		const Separation& separation = _separations[i];
+		NodeId lower = separation.lower;
+		NodeId upper = separation.upper;
+
+		// min <= h[upper] - h[lower] <= max, unless implied by the bounds
+		if (_min_levels[upper] - _max_levels[lower] < separation.min_separation)
+			slice.emplace(GreaterEqual, separation.min_separation)
+					.setCoefficient(upper,  1.0)
+					.setCoefficient(lower, -1.0);
+		if (_max_levels[upper] - _min_levels[lower] > separation.max_separation)
+			slice.emplace(LessEqual, separation.max_separation)
+					.setCoefficient(upper,  1.0)
+					.setCoefficient(lower, -1.0);
+	});
+}
+
+Solution
+IlpSolver::heights(const std::vector<int>& levels) const {
+
+	Solution solution(_statistics.num_variables);
+
+	for (NodeId n = 0; n < _num_nodes; n++) {
+
+		const int* breakpoints = &_breakpoints[_first_breakpoints[n]];
+		std::size_t num_segments = _first_breakpoints[n + 1] - _first_breakpoints[n] - 1;
+
+		int level = std::min(std::max(levels[n], _min_levels[n]), _max_levels[n]);
+		solution[n] = level;
+
+		std::size_t z = _first_order_var_nums[n];
+		for (std::size_t k = 0; k < num_segments; k++) {
+
+			double fraction =
+					static_cast<double>(std::min(std::max(level - breakpoints[k], 0), breakpoints[k + 1] - breakpoints[k]))/
+					(breakpoints[k + 1] - breakpoints[k]);
+
+			solution[segment_var_num(n, k)] = fraction;
+
+			if (is_concave_breakpoint(n, k))
+				solution[z++] = (fraction > 0 ? 1.0 : 0.0);
+		}
+	}
+
+	set_penalty_variables(levels, solution);
+
+	return solution;
+}
+
+double
+IlpSolver::solve_ilp() {
+
+	LinearSolverBackend::Parameters solverParameters;
+	solverParameters.numThreads = _parameters.num_threads;
+	solverParameters.verbose    = _parameters.verbose;
+
+	Solution solution;
+	std::string message;
+
+	while (true) {
+
+		LOG_DEBUG(ilpsolverlog) << "solving" << std::endl;
+		if (!_solver->solve(solution, message, solverParameters))
+			UTIL_THROW_EXCEPTION(
+					LinearSolverBackendException,
+					"linear program could not be solved: " << message);
+
+		if (!_parameters.lazy_constraints)
+			break;
+
+		// cutting plane round: generate the gradient and zero-minimum
+		// constraints again, pass the ones violated by the solution and not
+		// added before to the solver and solve again, until none are violated
+		LinearSolverBackendSink backend_sink(*_solver);
+		ViolatedConstraintFilter violated(backend_sink, solution, 1e-6, _lazy_constraints_added);
+		LinearConstraintStream constraints(violated);
+
+		if (_parameters.formulation == Heights)
+			add_height_gradient_constraints(_parameters, constraints);
+		else
+			add_surface_constraints(_parameters, constraints);
+		constraints.flush();
+
+		if (violated.num_violated() == 0)
+			break;
+
+		LOG_DEBUG(ilpsolverlog) << "added " << violated.num_violated() << " violated constraints" << std::endl;
+
+		_statistics.num_constraints += violated.num_violated();
+		_statistics.num_lazy_rounds++;
+	}
+
+	LOG_ALL(ilpsolverlog) << solution.getVector() << std::endl;
+
+	if (_integral_lp) {
+
+		// the LP should have returned an integral vertex, but this is not
+		// guaranteed for all solver algorithms (e.g., barrier without
+		// crossover)
+		for (std::size_t i = 0; i < solution.size(); i++) {
+
+			if (std::fabs(solution[i] - std::round(solution[i])) > 1e-6) {
+
+				LOG_USER(ilpsolverlog) << "LP solution is not integral, solving as ILP" << std::endl;
+
+				_statistics.solved_as_lp = false;
+				_statistics.lp_fallback  = true;
+
+				build_ilp(_parameters, false);
+
+				if (!_initial_levels.empty()) {
+
+					LOG_DEBUG(ilpsolverlog) << "setting initial solution" << std::endl;
+					_solver->setInitialSolution(indicators(_initial_levels));
+				}
+
+				return solve_ilp();
+			}
+		}
+
+		_statistics.solved_as_lp = true;
+	}
+
+	_levels.resize(_num_nodes);
+
+	if (_parameters.formulation == Heights) {
+
+		// the heights are only fractional for the relaxed problem
+		for (NodeId n = 0; n < _num_nodes; n++)
+			_levels[n] = std::min(std::max(static_cast<int>(std::round(solution[n])), _min_levels[n]), _max_levels[n]);
+
+		return solution.getValue() + _objective_offset;
+	}
+
+	// read the levels from the indicators, only the levels are kept
+	for (NodeId n = 0; n < _num_nodes; n++) {
+
+		int level = _min_levels[n];
+		while (level < _max_levels[n] && solution[var_num(n, level + 1)] >= 0.5)
+			level++;
+
+		_levels[n] = level;
+	}
+
+	return solution.getValue() + _objective_offset;
+}
+
+double
+IlpSolver::min_surface_min_cut(const Parameters& parameters) {
+
+	if (parameters.enforce_zero_minimum)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"'enforce_zero_minimum' is not supported by the MinCut engine");
+
+	// The surface constraints describe a closure problem on the indicators
+	// x[n,l]: x[n,l]=1 implies x[n,l-1]=1 (column inclusion), x[v,l-g]=1
+	// (gradient), and similar for the separations. As for the ILP, only the indicators within the level range
+	// of each node are part of the flow graph, i.e., column n is represented
+	// by the flow nodes for levels _min_levels[n]+1,...,_max_levels[n]. A
+	// minimal closure is the source set of a minimal cut, where each
+	// indicator is connected to the source if its objective coefficient is
+	// negative and to the sink otherwise, and each implication is an
+	// infinite edge.
+
+	find_level_ranges(parameters, _min_levels, _max_levels);
+
+	_first_var_nums.resize(_num_nodes + 1);
+	_first_var_nums[0] = 0;
+	for (NodeId n = 0; n < _num_nodes; n++)
+		_first_var_nums[n + 1] = _first_var_nums[n] + (_max_levels[n] - _min_levels[n]);
+
+	// column inclusion and exclusion of levels with infinite costs
+	std::size_t num_flow_nodes = _first_var_nums.back();
+	std::size_t num_flow_edges = 2*num_flow_nodes;
+	for (GraphType::EdgeIt e(_graph); e != lemon::INVALID; ++e) {
+
+		NodeId u = _graph.id(_graph.u(e));
+		NodeId v = _graph.id(_graph.v(e));
+
+		num_flow_edges += (_max_levels[u] - _min_levels[u]) + (_max_levels[v] - _min_levels[v]);
+
+		// one edge per level of u and kink of the penalty
+		if (_penalty_ids[e] >= 0 && u != v)
+			num_flow_edges +=
+					(_max_levels[u] - _min_levels[u])*
+					(2*std::min<std::size_t>(_penalties[_penalty_ids[e]].size(), _max_gradients[e]) + 1);
+	}
+	for (const Separation& separation : _separations)
+		num_flow_edges +=
+				(_max_levels[separation.lower] - _min_levels[separation.lower]) +
+				(_max_levels[separation.upper] - _min_levels[separation.upper]);
+
+	LOG_DEBUG(ilpsolverlog)
+			<< "creating flow graph with " << num_flow_nodes << " nodes and at most "
+			<< num_flow_edges << " edges" << std::endl;
+
+	_solver.reset();
+	_flow.reset();
+
+	if (parameters.num_threads > 1) {
+
+		ParallelMaxFlow flow(num_flow_nodes, num_flow_edges, parameters.num_threads);
+		build_closure_graph(flow);
+
+		LOG_DEBUG(ilpsolverlog) << "computing max-flow with " << parameters.num_threads << " threads" << std::endl;
+		flow.max_flow();
+
+		return read_closure(flow);
+
+	} else {
+
+		// keep the flow graph for resolve()
+		_flow = std::unique_ptr<MaxFlow>(new MaxFlow(num_flow_nodes, num_flow_edges));
+		build_closure_graph(*_flow);
+
+		LOG_DEBUG(ilpsolverlog) << "computing max-flow" << std::endl;
+		_flow->max_flow();
+
+		return read_closure(*_flow);
+	}
+}
+
+template <typename FlowType>
+void
+IlpSolver::build_closure_graph(FlowType& flow) {
+
+	const double infinity = std::numeric_limits<double>::infinity();
+
+	flow.add_nodes(_first_var_nums.back());
+
+	LOG_DEBUG(ilpsolverlog) << "adding terminal and column inclusion edges" << std::endl;
+	for (NodeId n = 0; n < _num_nodes; n++) {
+
+		for (int l = _min_levels[n] + 1; l <= _max_levels[n]; l++) {
+
+			double accumulated_costs = _level_costs.accumulated(n, l);
+
+			if (accumulated_costs < 0)
+				flow.add_tweights(var_num(n, l), -accumulated_costs, 0);
+			else
+				flow.add_tweights(var_num(n, l), 0, accumulated_costs);
+
+			if (l > _min_levels[n] + 1)
+				flow.add_edge(var_num(n, l), var_num(n, l - 1), infinity, 0);
+
+			// levels with infinite costs can not be the level of n: x[n,l] ⇒
+			// x[n,l+1] (the presolve keeps them away from the ends of the
+			// range)
+			if (l < _max_levels[n] && std::isinf(_level_costs(n, l)))
+				flow.add_edge(var_num(n, l), var_num(n, l + 1), infinity, 0);
+		}
+	}
+
+	LOG_DEBUG(ilpsolverlog) << "adding gradient edges" << std::endl;
+	for (GraphType::EdgeIt e(_graph); e != lemon::INVALID; ++e) {
+
+		NodeId u = _graph.id(_graph.u(e));
+		NodeId v = _graph.id(_graph.v(e));
+		int g = _max_gradients[e];
+
+		// loops are always satisfied
+		if (u == v)
+			continue;
+
+		// x[u,l] ⇒ x[v,l-g] and x[v,l] ⇒ x[u,l-g]
+		add_difference_edges(flow, u, v, g);
+		add_difference_edges(flow, v, u, g);
+
+		if (_penalty_ids[e] >= 0)
+			add_penalty_edges(flow, u, v, g, _penalty_ids[e]);
+	}
+
+	if (!_separations.empty())
+		LOG_DEBUG(ilpsolverlog) << "adding separation edges" << std::endl;
+
+	for (const Separation& separation : _separations) {
+
+		// x[lower,l] ⇒ x[upper,l+min] and x[upper,l] ⇒ x[lower,l-max]
+		add_difference_edges(flow, separation.lower, separation.upper, -separation.min_separation);
+		add_difference_edges(flow, separation.upper, separation.lower, separation.max_separation);
+	}
+}
+
+template <typename FlowType>
+void
+IlpSolver::add_difference_edges(FlowType& flow, NodeId u, NodeId v, int d) {
+
+	const double infinity = std::numeric_limits<double>::infinity();
+
+	// x[u,l] ⇒ x[v,l-d], only for the indicators x[u,l] that are not 0 and
+	// x[v,l-d] that are not 1
+	for (int l = std::max(0, _min_levels[v] + d + 1); l <= _max_levels[u]; l++) {
+
+		bool upper_fixed = (indicator(u, l) == 1);
+		bool lower_fixed = (indicator(v, l - d) == 0);
+
+		if (upper_fixed && lower_fixed)
+			UTIL_THROW_EXCEPTION(
+					Exception,
+					"there is no surface that satisfies the constraints between nodes " <<
+					u << " and " << v << " within their level ranges");
+
+		// without presolve, the ranges might force indicators to 1 or 0
+		if (upper_fixed)
+			flow.add_tweights(var_num(v, l - d), infinity, 0);
+		else if (lower_fixed)
+			flow.add_tweights(var_num(u, l), 0, infinity);
+		else
+			flow.add_edge(var_num(u, l), var_num(v, l - d), infinity, 0);
+	}
+}
+
+template <typename FlowType>
+void
+IlpSolver::add_penalty_edges(FlowType& flow, NodeId u, NodeId v, int g, std::size_t p) {
+
+	// Only differences up to g are feasible, beyond them the penalty is
+	// continued linearly, which keeps it convex but limits the number of
+	// kinks (and thus edges) to the ones within [-g, g].
+	double slope = (g > 0 ? penalty(p, g) - penalty(p, g - 1) : 0.0);
+	auto phi = [&](int d) {
+
+		d = std::abs(d);
+		return (d <= g ? penalty(p, d) : penalty(p, g) + (d - g)*slope);
+	};
+
+	// the second difference of phi at d, non-negative since phi is convex
+	auto kink = [&](int d) {
+
+		return phi(d + 1) - 2*phi(d) + phi(d - 1);
+	};
+
+	// Ishikawa's construction: phi(h[u] - h[v]) equals, up to a constant,
+	//
+	//   Σ_{i,j} kink(i - j)*x[u,i]*(1 - x[v,j]) + A(h[u]) + B(h[v])
+	//
+	// where the first sum are the edges (u,i) → (v,j) and the unary terms
+	// A and B are passed as terminal weights of the indicators (with the
+	// same sign convention as the accumulated costs). A(h[u]) + B(min_v)
+	// and A(min_u) + B(h[v]) have to equal phi(h[u] - min_v) and phi(min_u
+	// - h[v]), which determines the weights.
+	const int min_u = _min_levels[u];
+	const int max_u = _max_levels[u];
+	const int min_v = _min_levels[v];
+	const int max_v = _max_levels[v];
+
+	auto add_unary = [&](NodeId n, int l, double costs) {
+
+		if (costs < 0)
+			flow.add_tweights(var_num(n, l), -costs, 0);
+		else if (costs > 0)
+			flow.add_tweights(var_num(n, l), 0, costs);
+	};
+
+	for (int i = min_u + 1; i <= max_u; i++) {
+
+		double costs = phi(i - min_v) - phi(i - 1 - min_v);
+
+		for (int j = std::max(min_v + 1, i - g + 1); j <= std::min(max_v, i + g - 1); j++) {
+
+			double capacity = kink(i - j);
+
+			if (capacity <= 0)
+				continue;
+
+			flow.add_edge(var_num(u, i), var_num(v, j), capacity, 0);
+			costs -= capacity;
+		}
+
+		add_unary(u, i, costs);
+	}
+
+	for (int j = min_v + 1; j <= max_v; j++)
+		add_unary(v, j, phi(min_u - j) - phi(min_u - j + 1));
+}
+
+template <typename FlowType>
+double
+IlpSolver::read_closure(const FlowType& flow) {
+
+	// the minimal closure contains the levels min+1,...,h of each column
+	_levels.resize(_num_nodes);
+
+	double value = 0;
+	for (NodeId n = 0; n < _num_nodes; n++) {
+
+		int level = _min_levels[n];
+		while (level < _max_levels[n] && flow.in_source_segment(var_num(n, level + 1)))
+			level++;
+
+		_levels[n] = level;
+		value += _level_costs(n, level);
+	}
+
+	return value + penalty_costs(_levels);
+}
+
+double
+IlpSolver::min_surface_dp(const Parameters& parameters) {
+
+	if (parameters.enforce_zero_minimum)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"'enforce_zero_minimum' is not supported by the DynamicProgramming engine");
+
+	if (!_separations.empty())
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"separation constraints are not supported by the DynamicProgramming engine");
+
+	// the same check as in find_level_ranges(), which is not used here
+	for (NodeId n = 0; n < _num_nodes; n++) {
+
+		int l = _first_levels[n];
+		while (l <= _last_levels[n] && std::isinf(_level_costs(n, l)))
+			l++;
+
+		if (l > _last_levels[n])
+			UTIL_THROW_EXCEPTION(
+					Exception,
+					"all levels of node " << n << " have infinite costs");
+	}
+
+	_solver.reset();
+	_flow.reset();
+
+	const std::size_t none = static_cast<std::size_t>(-1);
+
+	// collect the edges with their penalties, merge parallel edges by taking
+	// the smallest gradient, and skip loops (they are always satisfied, their
+	// penalties are added to the value below)
+
+	std::vector<std::tuple<NodeId, NodeId, int, int>> edges;
+	edges.reserve(_num_edges);
+	for (GraphType::EdgeIt e(_graph); e != lemon::INVALID; ++e) {
+
+		NodeId u = _graph.id(_graph.u(e));
+		NodeId v = _graph.id(_graph.v(e));
+
+		if (u != v)
+			edges.push_back(std::make_tuple(std::min(u, v), std::max(u, v), _max_gradients[e], _penalty_ids[e]));
+	}
+
+	std::sort(edges.begin(), edges.end());
+
+	std::size_t num_edges = 0;
+	for (std::size_t i = 0; i < edges.size(); i++) {
+
+		if (num_edges > 0 &&
+			std::get<0>(edges[num_edges-1]) == std::get<0>(edges[i]) &&
+			std::get<1>(edges[num_edges-1]) == std::get<1>(edges[i])) {
+
+			if (std::get<3>(edges[num_edges-1]) >= 0 || std::get<3>(edges[i]) >= 0)
+				UTIL_THROW_EXCEPTION(
+						UsageError,
+						"the DynamicProgramming engine does not support parallel edges with penalties, "
+						"found several edges between nodes " << std::get<0>(edges[i]) << " and " << std::get<1>(edges[i]));
+
+			continue; // sorted, the first one has the smallest gradient
+		}
+
+		edges[num_edges++] = edges[i];
+	}
+	edges.resize(num_edges);
+
+	if (num_edges >= _num_nodes && _num_nodes > 0)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"the DynamicProgramming engine needs the graph to be a forest, "
+				"but it has " << num_edges << " edges between " << _num_nodes << " nodes");
+
+	// adjacency lists in compressed form
+
+	std::vector<std::size_t> first_neighbor(_num_nodes + 1, 0);
+	for (const auto& edge : edges) {
+
+		first_neighbor[std::get<0>(edge) + 1]++;
+		first_neighbor[std::get<1>(edge) + 1]++;
+	}
+	for (std::size_t n = 0; n < _num_nodes; n++)
+		first_neighbor[n + 1] += first_neighbor[n];
+
+	std::vector<NodeId> neighbors(2*num_edges);
+	std::vector<int> gradients(2*num_edges);
+	std::vector<int> penalty_ids(2*num_edges);
+	std::vector<std::size_t> next_neighbor(first_neighbor.begin(), first_neighbor.end() - 1);
+	for (const auto& edge : edges) {
+
+		NodeId u = std::get<0>(edge);
+		NodeId v = std::get<1>(edge);
+
+		neighbors[next_neighbor[u]] = v;
+		gradients[next_neighbor[u]] = std::get<2>(edge);
+		penalty_ids[next_neighbor[u]++] = std::get<3>(edge);
+		neighbors[next_neighbor[v]] = u;
+		gradients[next_neighbor[v]] = std::get<2>(edge);
+		penalty_ids[next_neighbor[v]++] = std::get<3>(edge);
+	}
+
+	// order the nodes by a breadth-first search in each tree, such that
+	// parents come before their children
+
+	std::vector<NodeId> order;
+	std::vector<NodeId> parents(_num_nodes, none);
+	std::vector<int> parent_gradients(_num_nodes, 0);
+	std::vector<int> parent_penalties(_num_nodes, -1);
+	std::vector<bool> visited(_num_nodes, false);
+	order.reserve(_num_nodes);
+
+	for (NodeId root = 0; root < _num_nodes; root++) {
+
+		if (visited[root])
+			continue;
+
+		visited[root] = true;
+		order.push_back(root);
+
+		for (std::size_t i = order.size() - 1; i < order.size(); i++) {
+
+			NodeId u = order[i];
+
+			for (std::size_t j = first_neighbor[u]; j < first_neighbor[u + 1]; j++) {
+
+				NodeId v = neighbors[j];
+
+				if (v == parents[u])
+					continue;
+
+				if (visited[v])
+					UTIL_THROW_EXCEPTION(
+							UsageError,
+							"the DynamicProgramming engine needs the graph to be a "
+							"forest, but node " << v << " is part of a cycle");
+
+				visited[v] = true;
+				parents[v] = u;
+				parent_gradients[v] = gradients[j];
+				parent_penalties[v] = penalty_ids[j];
+				order.push_back(v);
+			}
+		}
+	}
+
+	// min-sum messages from the leaves to the roots: f[n,l] are the minimal
+	// costs of the subtree below n if n is at level l, the message to the
+	// parent is the minimum of f[n,.] over the levels allowed by the gradient
+	// (plus the penalty of the edge to the parent, if any)
+
+	LOG_DEBUG(ilpsolverlog) << "passing messages in " << _num_nodes << " nodes" << std::endl;
+
+	// levels outside of the level ranges have infinite costs
+	const double infinity = std::numeric_limits<double>::infinity();
+	const int num_levels = _num_levels;
+	std::vector<double> f(_num_nodes*num_levels, infinity);
+	for (NodeId n = 0; n < _num_nodes; n++)
+		for (int l = _first_levels[n]; l <= _last_levels[n]; l++)
+			f[n*num_levels + l] = _level_costs(n, l);
+
+	std::vector<double> message(num_levels);
+	std::vector<double> prefix;
+	std::vector<double> suffix;
+
+	for (auto i = order.rbegin(); i != order.rend(); i++) {
+
+		NodeId v = *i;
+		NodeId u = parents[v];
+
+		if (u == none)
+			continue;
+
+		const int g = parent_gradients[v];
+
+		if (parent_penalties[v] < 0) {
+
+			min_filter(&f[v*num_levels], &message[0], num_levels, g, prefix, suffix);
+
+		} else {
+
+			// the penalty depends on the difference, no sliding minimum
+			const double* fv = &f[v*num_levels];
+			for (int l = 0; l < num_levels; l++) {
+
+				message[l] = infinity;
+				for (int k = std::max(l - g, 0); k <= std::min(l + g, num_levels - 1); k++)
+					message[l] = std::min(message[l], fv[k] + penalty(parent_penalties[v], std::abs(k - l)));
+			}
+		}
+
+		double*       fu = &f[u*num_levels];
+		const double* m  = &message[0];
+		for (int l = 0; l < num_levels; l++)
+			fu[l] += m[l];
+	}
+
+	// choose the best level of each root and the best levels of the children
+	// given the level of their parent
+
+	_levels.resize(_num_nodes);
+	std::vector<int>& levels = _levels;
+	for (NodeId v : order) {
+
+		const double* fv = &f[v*num_levels];
+		NodeId u = parents[v];
+
+		int begin = _first_levels[v];
+		int end   = _last_levels[v] + 1;
+
+		if (u != none) {
+
+			begin = std::max(levels[u] - parent_gradients[v], begin);
+			end   = std::min(levels[u] + parent_gradients[v] + 1, end);
+
+			if (begin >= end)
+				UTIL_THROW_EXCEPTION(
+						Exception,
+						"there is no surface that satisfies the gradient constraints between "
+						"nodes " << u << " and " << v << " within their level ranges");
+		}
+
+		if (u == none) {
+
+			levels[v] = std::min_element(fv + begin, fv + end) - fv;
+
+			// infinite costs in the subtree can not be avoided
+			if (std::isinf(fv[levels[v]]))
+				UTIL_THROW_EXCEPTION(
+						Exception,
+						"there is no surface with finite costs for the tree of node " << v);
+
+			continue;
+		}
+
+		if (parent_penalties[v] < 0) {
+
+			levels[v] = std::min_element(fv + begin, fv + end) - fv;
+			continue;
+		}
+
+		levels[v] = begin;
+		double best = infinity;
+		for (int l = begin; l < end; l++) {
+
+			double costs = fv[l] + penalty(parent_penalties[v], std::abs(l - levels[u]));
+			if (costs < best) {
+
+				best = costs;
+				levels[v] = l;
+			}
+		}
+	}
+
+	double value = 0;
+	for (NodeId n = 0; n < _num_nodes; n++)
+		value += _level_costs(n, levels[n]);
+
+	return value + penalty_costs(levels);
+}
+
+void
+IlpSolver::update_level_costs(NodeId n, const std::vector<double>& costs) {
+
+	if (n >= _num_nodes)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"node " << n << " does not exist, there are only " << _num_nodes << " nodes");
+
+	std::vector<double> previous_accumulated(_num_levels);
+	std::vector<bool> previous_infinite(_num_levels);
+	for (int l = 0; l < _num_levels; l++) {
+
+		previous_accumulated[l] = _level_costs.accumulated(n, l);
+		previous_infinite[l] = std::isinf(_level_costs(n, l));
+	}
+
+	_level_costs.set(n, costs);
+
+	// levels with infinite costs are excluded by constraints or edges of the
+	// models, which can not be changed
+	for (int l = 0; l < _num_levels; l++)
+		if (std::isinf(_level_costs(n, l)) != previous_infinite[l]) {
+
+			discard_models();
+			break;
+		}
+
+	if (_flow) {
+
+		// change the terminal capacities of the column by the difference of
+		// the accumulated costs, resolve() rebuilds the graph if the level
+		// range of the column changes with the new costs
+		for (int l = _min_levels[n] + 1; l <= _max_levels[n]; l++) {
+
+			double delta = previous_accumulated[l] - _level_costs.accumulated(n, l);
+
+			if (delta == 0)
+				continue;
+
+			if (delta > 0)
+				_flow->add_tweights(var_num(n, l), delta, 0);
+			else
+				_flow->add_tweights(var_num(n, l), 0, -delta);
+
+			_flow->mark_node(var_num(n, l));
+		}
+	}
+
+	_changed_nodes.push_back(n);
+}
+
+double
+IlpSolver::resolve() {
+
+	double value;
+
+	if (_contracted) {
+
+		std::sort(_changed_nodes.begin(), _changed_nodes.end());
+		_changed_nodes.erase(std::unique(_changed_nodes.begin(), _changed_nodes.end()), _changed_nodes.end());
+
+		// sum up the costs of the changed super nodes again
+		std::vector<NodeId> changed_super_nodes;
+		for (NodeId n : _changed_nodes)
+			changed_super_nodes.push_back(_super_nodes[n]);
+		std::sort(changed_super_nodes.begin(), changed_super_nodes.end());
+		changed_super_nodes.erase(std::unique(changed_super_nodes.begin(), changed_super_nodes.end()), changed_super_nodes.end());
+
+		std::vector<std::vector<double>> costs(changed_super_nodes.size(), std::vector<double>(_num_levels, 0.0));
+		for (NodeId n = 0; n < _num_nodes; n++) {
+
+			auto i = std::lower_bound(changed_super_nodes.begin(), changed_super_nodes.end(), _super_nodes[n]);
+			if (i == changed_super_nodes.end() || *i != _super_nodes[n])
+				continue;
+
+			for (int l = 0; l < _num_levels; l++)
+				costs[i - changed_super_nodes.begin()][l] += _level_costs(n, l);
+		}
+
+		for (std::size_t i = 0; i < changed_super_nodes.size(); i++)
+			_contracted->update_level_costs(changed_super_nodes[i], costs[i]);
+
+		value = _contracted->resolve();
+
+		read_contracted_levels();
+
+	} else if (_flow) {
+
+		// the flow graph only contains the levels within the ranges, which
+		// depend on the costs
+		std::vector<int> min_levels;
+		std::vector<int> max_levels;
+		find_level_ranges(_parameters, min_levels, max_levels);
+
+		if (min_levels != _min_levels || max_levels != _max_levels) {
+
+			LOG_DEBUG(ilpsolverlog) << "level ranges changed, rebuilding the flow graph" << std::endl;
+			return min_surface(_parameters);
+		}
+
+		LOG_DEBUG(ilpsolverlog) << "recomputing max-flow, reusing search trees" << std::endl;
+		_flow->max_flow(true);
+
+		value = read_closure(*_flow);
+
+	} else if (_solver && _parameters.formulation == Heights) {
+
+		LOG_DEBUG(ilpsolverlog) << "costs changed, rebuilding the ILP of the heights" << std::endl;
+		return min_surface(_parameters);
+
+	} else if (_solver) {
+
+		// the fixed indicators depend on the costs
+		std::vector<int> min_levels;
+		std::vector<int> max_levels;
+		find_level_ranges(_parameters, min_levels, max_levels);
+
+		if (min_levels != _min_levels || max_levels != _max_levels) {
+
+			LOG_DEBUG(ilpsolverlog) << "level ranges changed, rebuilding the ILP" << std::endl;
+			return min_surface(_parameters);
+		}
+
+		std::sort(_changed_nodes.begin(), _changed_nodes.end());
+		_changed_nodes.erase(std::unique(_changed_nodes.begin(), _changed_nodes.end()), _changed_nodes.end());
+
+		std::vector<unsigned int> var_nums;
+		std::vector<double> coefs;
+		var_nums.reserve(_changed_nodes.size()*_num_levels);
+		coefs.reserve(_changed_nodes.size()*_num_levels);
+
+		for (NodeId n : _changed_nodes) {
+
+			for (int l = _min_levels[n] + 1; l <= _max_levels[n]; l++) {
+
+				var_nums.push_back(var_num(n, l));
+				coefs.push_back(_level_costs.accumulated(n, l));
+			}
+		}
+
+		LOG_DEBUG(ilpsolverlog) << "updating " << var_nums.size() << " objective coefficients" << std::endl;
+		_solver->setObjectiveCoefficients(var_nums, coefs);
+		_objective_offset = objective_offset();
+
+		_statistics.solved_as_lp = false;
+		_statistics.lp_fallback  = false;
+
+		value = solve_ilp();
+
+	} else {
+
+		return min_surface(_parameters);
+	}
+
+	_changed_nodes.clear();
+
+	return value;
+}
+
+void
+IlpSolver::dump_ilp(std::string filename) {
+
+	if (_contracted) {
+
+		_contracted->dump_ilp(filename);
+		return;
+	}
+
+	if (!_solver)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"there is no ILP to dump, call min_surface() with the Ilp engine first");
+
+	_solver->dumpProblem(filename);
+}
+
+int
+IlpSolver::level(NodeId n) {
+
+	if (n >= _levels.size())
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"no level found for node " << n << ", call min_surface() first");
+
+	if (_levels[n] < 0)
+		UTIL_THROW_EXCEPTION(
+				Exception,
+				"no level was selected for node " << n);
 
-	return _num_levels - 1;
+	return _levels[n];
 }
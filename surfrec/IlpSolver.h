@@ -1,9 +1,14 @@
 #ifndef PYSURFREC_SURFREC_ILP_SOLVER_GRAPH_H__
 #define PYSURFREC_SURFREC_ILP_SOLVER_GRAPH_H__
 
+#include <algorithm>
+#include <memory>
 #include <lemon/list_graph.h>
+#include <solver/LinearConstraintSink.h>
 #include <solver/SolverFactory.h>
 #include <util/helpers.hpp>
+#include "LevelCosts.h"
+#include "MaxFlow.h"
 
 /**
  * An ILP solver for the surface reconstruction problem. Formulates the 
@@ -15,9 +20,87 @@ public:
 
 	typedef std::size_t NodeId;
 
+	/**
+	 * The engines available to find the cost-minimal surface.
+	 */
+	enum Engine {
+
+		/**
+		 * Formulate the problem as an ILP and solve it with one of the linear
+		 * solver backends.
+		 */
+		Ilp,
+
+		/**
+		 * Solve the problem as a minimum closure problem with a native
+		 * max-flow/min-cut algorithm. Edge penalties become finite edges
+		 * between the levels of the two columns (Ishikawa's construction).
+		 * Does not support enforce_zero_minimum.
+		 */
+		MinCut,
+
+		/**
+		 * Solve the problem exactly by min-sum dynamic programming. Only
+		 * available if the graph is a forest (e.g., a chain of nodes), runs in
+		 * O(num_nodes*num_levels), or O(num_nodes*num_levels*max_gradient)
+		 * with edge penalties. Does not support enforce_zero_minimum,
+		 * separation constraints, or parallel edges with penalties.
+		 */
+		DynamicProgramming
+	};
+
+	/**
+	 * The formulations of the ILP for the Ilp engine. In both, the penalty
+	 * of an edge is a continuous variable bounded from below by each linear
+	 * piece of the penalty.
+	 */
+	enum Formulation {
+
+		/**
+		 * One binary indicator x[n,l] per node and level, such that the
+		 * model grows linearly with num_levels.
+		 */
+		Indicators,
+
+		/**
+		 * One integer height variable h[n] per node and two constraints
+		 * |h[u] - h[v]| <= g per edge. The level costs of each column are
+		 * split into segments between the levels where their slope changes,
+		 * each with a continuous variable for the fraction of the segment
+		 * below the surface. Only segments after a decrease of the slope
+		 * (where the costs are not convex) need a binary variable to be
+		 * filled in order. The model shrinks by up to a factor of num_levels
+		 * if the costs have few slope changes (e.g., piecewise-linear
+		 * costs). Does not support enforce_zero_minimum, and the costs
+		 * within the level range of each column have to be finite.
+		 */
+		Heights
+	};
+
 	struct Parameters {
 
-		Parameters() : enforce_zero_minimum(false), num_neighbors(-1), num_threads(0) {}
+		Parameters() :
+			engine(Ilp),
+			formulation(Indicators),
+			enforce_zero_minimum(false),
+			num_neighbors(-1),
+			num_threads(0),
+			solve_relaxed_problem(false),
+			detect_integral_lp(true),
+			lazy_constraints(false),
+			presolve(true),
+			contract_zero_gradient_edges(true),
+			verbose(false) {}
+
+		/**
+		 * The engine to use for finding the minimal surface.
+		 */
+		Engine engine;
+
+		/**
+		 * The formulation of the ILP, if the Ilp engine is used.
+		 */
+		Formulation formulation;
 
 		/**
 		 * If set to true, the ILP ensures that every minimum has a value of 
@@ -33,7 +116,10 @@ public:
 		int num_neighbors;
 
 		/**
-		 * The number of threads to use for inference.
+		 * The number of threads to use for inference. For the MinCut engine,
+		 * values larger than 1 select a parallel push-relabel algorithm. For
+		 * the Ilp engine, the objective and constraints are also generated
+		 * with this number of threads, in the same order as with one thread.
 		 */
 		int num_threads;
 
@@ -43,12 +129,111 @@ public:
 		*/
 		bool solve_relaxed_problem;
 
+		/**
+		 * If the constraints of the ILP are totally unimodular (which is the
+		 * case without enforce_zero_minimum), solve it as an LP, which has an
+		 * integral optimum. If the solver returns a fractional solution
+		 * nevertheless, the ILP is solved instead.
+		 */
+		bool detect_integral_lp;
+
+		/**
+		 * Start with the indicator and column inclusion constraints only, and
+		 * add gradient and zero-minimum constraints in rounds, only if they
+		 * are violated by the current solution. Gives the same optimum with a
+		 * smaller model, if most of these constraints are not tight. Note
+		 * that each round generates and checks all gradient and zero-minimum
+		 * constraints again, which costs as much time as building them for
+		 * the full model.
+		 */
+		bool lazy_constraints;
+
+		/**
+		 * Before building the ILP or flow graph, narrow down the range of
+		 * possible levels of each node (see set_level_range()): levels with
+		 * infinite costs at the bottom or top of a column are excluded, nodes
+		 * without neighbors or separations are fixed to their best level,
+		 * and the ranges are propagated over the gradient and separation
+		 * constraints. Indicators outside of the ranges are not passed to
+		 * the solver. Always enabled for the MinCut engine.
+		 */
+		bool presolve;
+
+		/**
+		 * Merge nodes that are connected by edges with a max gradient of
+		 * zero (and therefore have to be on the same level) into one column
+		 * with the summed level costs, and solve the smaller problem with
+		 * the selected engine. Not applied if enforce_zero_minimum is set.
+		 */
+		bool contract_zero_gradient_edges;
+
 		/**
 		 * Enable verbose output of the ILP solver.
 		 */
 		bool verbose;
 	};
 
+	/**
+	 * Statistics about the last call to min_surface() or resolve().
+	 */
+	struct Statistics {
+
+		Statistics() :
+			engine(Ilp),
+			num_variables(0),
+			num_constraints(0),
+			solved_as_lp(false),
+			lp_fallback(false),
+			num_lazy_rounds(0),
+			num_removed_variables(0),
+			num_removed_constraints(0),
+			num_contracted_nodes(0) {}
+
+		/**
+		 * The engine that was used.
+		 */
+		Engine engine;
+
+		/**
+		 * The number of variables and constraints of the ILP, if the Ilp
+		 * engine was used.
+		 */
+		std::size_t num_variables;
+		std::size_t num_constraints;
+
+		/**
+		 * Whether the ILP was solved as an LP with an integral solution (see
+		 * Parameters::detect_integral_lp).
+		 */
+		bool solved_as_lp;
+
+		/**
+		 * Whether the ILP was solved as an LP first, but the solution was not
+		 * integral, such that the ILP had to be solved.
+		 */
+		bool lp_fallback;
+
+		/**
+		 * The number of rounds in which violated constraints were added, if
+		 * Parameters::lazy_constraints was set.
+		 */
+		std::size_t num_lazy_rounds;
+
+		/**
+		 * The number of variables and constraints that were not passed to the
+		 * solver because of fixed indicators (see Parameters::presolve),
+		 * compared to the ILP with one variable per node and level.
+		 */
+		std::size_t num_removed_variables;
+		std::size_t num_removed_constraints;
+
+		/**
+		 * The number of nodes that were merged into other nodes (see
+		 * Parameters::contract_zero_gradient_edges).
+		 */
+		std::size_t num_contracted_nodes;
+	};
+
 	/**
 	 * Create a new IlpSolver solver for the given estimated number 
 	 * of nodes and edges (of the original graph). More nodes and edges can be 
@@ -64,8 +249,16 @@ public:
 	 * @param max_gradient
 	 *              The maximal gradient that the surface can have between two 
 	 *              neighboring nodes.
+	 * @param single_precision_costs
+	 *              Store the level costs as float instead of double, to save
+	 *              memory for large problems.
 	 */
-	IlpSolver(std::size_t num_nodes, std::size_t num_edges, int num_levels, int max_gradient);
+	IlpSolver(
+			std::size_t num_nodes,
+			std::size_t num_edges,
+			int num_levels,
+			int max_gradient,
+			bool single_precision_costs = false);
 
 	/**
 	 * Add n nodes to the graph, return the index to the first one.
@@ -74,10 +267,54 @@ public:
 
 	/**
 	 * Set the costs for passing the surface through the different levels of a 
-	 * column.
+	 * column. Columns without costs set have costs of zero. Levels with
+	 * infinite costs are excluded from the solution (the Heights formulation
+	 * only supports them at the bottom or top of a column).
 	 */
 	void set_level_costs(NodeId n, const std::vector<double>& costs);
 
+	/**
+	 * Set the level costs of the nodes first,...,first+num_nodes-1 from a
+	 * strided buffer of values of type T (float or double), without
+	 * intermediate copies. See LevelCosts::set() for the memory layout.
+	 */
+	template <typename T>
+	void set_level_costs(
+			NodeId first,
+			std::size_t num_nodes,
+			const T* data,
+			std::ptrdiff_t node_stride,
+			std::ptrdiff_t level_stride) {
+
+		discard_models();
+
+		_level_costs.set(first, num_nodes, data, node_stride, level_stride);
+	}
+
+	/**
+	 * Restrict the surface to pass through column n at one of the levels
+	 * first_level,...,last_level (e.g., from a prior segmentation). Only
+	 * these levels become variables of the ILP and nodes of the flow graph,
+	 * such that the size of the problem scales with the width of the
+	 * ranges instead of num_levels. By default, all levels are allowed.
+	 */
+	void set_level_range(NodeId n, int first_level, int last_level);
+
+	/**
+	 * The number of nodes added so far.
+	 */
+	std::size_t num_nodes() const { return _num_nodes; }
+
+	/**
+	 * The number of edges added so far.
+	 */
+	std::size_t num_edges() const { return _num_edges; }
+
+	/**
+	 * The number of levels in each column.
+	 */
+	int num_levels() const { return _num_levels; }
+
 	/**
 	 * Add a neighborhood edge between nodes u and v. Optionally set the 
 	 * maximally allowed absolute difference between estimated values for u and 
@@ -88,11 +325,129 @@ public:
 	void add_edge(NodeId u, NodeId v, int max_gradient);
 
 	/**
-	 * Find the cost-minimal surface.
+	 * Add an edge with a soft smoothness penalty in addition to the max
+	 * gradient: if the levels of u and v differ by d, the penalty with the
+	 * given id (see add_penalty()) adds its costs for d to the costs of the
+	 * surface.
+	 */
+	void add_edge(NodeId u, NodeId v, int max_gradient, std::size_t penalty);
+
+	/**
+	 * Add the edges of a regular lattice. The nodes of the solver have to
+	 * correspond to the nodes of the grid in C order (the last axis varies
+	 * fastest). See GridTopology for the meaning of the arguments.
+	 *
+	 * @param shape
+	 *              The size of the grid along each axis.
+	 * @param connectivity
+	 *              The number of neighbors of a node inside the grid (e.g., 4
+	 *              or 8 in 2D, 6 or 26 in 3D).
+	 * @param max_gradients
+	 *              The maximal gradient along each axis, or a single value for
+	 *              all axes.
+	 * @param wrap_around
+	 *              Whether the grid wraps around along each axis, or a single
+	 *              value for all axes. Empty for no wrap-around.
+	 */
+	void add_grid_edges(
+			const std::vector<std::size_t>& shape,
+			int connectivity,
+			const std::vector<int>& max_gradients,
+			const std::vector<bool>& wrap_around = std::vector<bool>());
+
+	/**
+	 * Add the edges of a regular lattice with the given soft smoothness
+	 * penalty on all of them (see add_penalty()).
+	 */
+	void add_grid_edges(
+			const std::vector<std::size_t>& shape,
+			int connectivity,
+			const std::vector<int>& max_gradients,
+			const std::vector<bool>& wrap_around,
+			std::size_t penalty);
+
+	/**
+	 * Add a convex penalty for the differences between the levels of
+	 * neighboring nodes, and return its id to be used with add_edge() and
+	 * add_grid_edges(). costs[d] are the costs for a difference of d, the
+	 * costs of larger differences are extrapolated linearly from the last
+	 * two values (e.g., {0, w} for w*|h_u - h_v|). The costs have to be
+	 * non-decreasing and convex in d, such that the Ilp and MinCut engines
+	 * find the exact minimum.
+	 */
+	std::size_t add_penalty(const std::vector<double>& costs);
+
+	/**
+	 * Reserve memory for the given total number of edges, to avoid
+	 * re-allocations when many edges are added at once.
+	 */
+	void reserve_edges(std::size_t num_edges);
+
+	/**
+	 * Add a separation constraint between nodes lower and upper: the surface
+	 * has to pass through the column of upper at least min_separation and at
+	 * most max_separation levels above the column of lower. With the columns
+	 * of several surfaces added as separate nodes, this finds nested
+	 * surfaces in one solve (see MultiSurfaceSolver). Not supported by the
+	 * DynamicProgramming engine.
+	 */
+	void add_separation(NodeId lower, NodeId upper, int min_separation, int max_separation);
+
+	/**
+	 * The number of separation constraints added so far.
+	 */
+	std::size_t num_separations() const { return _separations.size(); }
+
+	/**
+	 * Test whether there is a surface with finite costs that satisfies the
+	 * level ranges, gradient, and separation constraints (zero-minimum
+	 * constraints are not considered), without solving the problem. Runs
+	 * the range propagation of the presolve.
+	 */
+	bool has_feasible_surface() const;
+
+	/**
+	 * Find the cost-minimal surface. The returned costs include the
+	 * penalties of the edges.
 	 */
 	double min_surface();
 	double min_surface(const Parameters& parameters);
 
+	/**
+	 * Find the cost-minimal surface, starting the search from a surface with
+	 * the given level per node (e.g., the solution of a previous frame or of
+	 * a coarser problem). Only the Ilp engine makes use of the initial
+	 * levels, which are passed to the solver backend as a MIP start.
+	 */
+	double min_surface(const Parameters& parameters, const std::vector<int>& initial_levels);
+
+	/**
+	 * Change the level costs of node n after min_surface() was called. The
+	 * changes are applied to the model kept from the last call to
+	 * min_surface(), such that resolve() does not have to rebuild it, unless
+	 * levels get or lose infinite costs.
+	 */
+	void update_level_costs(NodeId n, const std::vector<double>& costs);
+
+	/**
+	 * Find the cost-minimal surface again after the level costs have been
+	 * changed with update_level_costs(), using the same parameters as the
+	 * last call to min_surface().
+	 *
+	 * For the MinCut engine (with a single thread), the flow and search trees
+	 * of the last max-flow are reused. For the Ilp engine, only the changed
+	 * objective coefficients are passed to the solver backend, which keeps
+	 * its model (except for the Heights formulation, whose model depends on
+	 * the slopes of the costs). In all other cases, the problem is solved
+	 * from scratch. If the graph was contracted along zero-gradient edges,
+	 * the contracted problem is resolved in the same way.
+	 *
+	 * Adding nodes, edges, penalties, or separations, setting level ranges,
+	 * or setting costs with set_level_costs() discards the kept model, and
+	 * the next resolve() solves the problem from scratch.
+	 */
+	double resolve();
+
 	/**
 	 * Return the level where the found surface passes through the column of 
 	 * node n.
@@ -100,26 +455,297 @@ public:
 	int level(NodeId n);
 
 	/**
-	 * Dump the ILP into a text file.
+	 * The levels of all nodes found by the last call to min_surface() or
+	 * resolve().
 	 */
-	void dump_ilp(std::string filename) { _solver->dumpProblem(filename); }
+	const std::vector<int>& levels() const { return _levels; }
+
+	/**
+	 * Statistics about the last call to min_surface() or resolve().
+	 */
+	const Statistics& statistics() const { return _statistics; }
+
+	/**
+	 * Dump the ILP into a text file. Only available after min_surface() was
+	 * called with the Ilp engine.
+	 */
+	void dump_ilp(std::string filename);
 
 private:
 
 	typedef lemon::ListGraph GraphType;
 
+	// min_separation <= h[upper] - h[lower] <= max_separation
+	struct Separation {
+
+		NodeId lower;
+		NodeId upper;
+		int min_separation;
+		int max_separation;
+	};
+
+	// the costs of penalty p for a difference of d >= 0 between the levels
+	// of two nodes, extrapolated linearly beyond the given costs
+	double penalty(std::size_t p, int d) const {
+
+		const std::vector<double>& costs = _penalties[p];
+		int last = costs.size() - 1;
+
+		if (d <= last)
+			return costs[d];
+
+		double slope = (last > 0 ? costs[last] - costs[last - 1] : 0.0);
+		return costs[last] + (d - last)*slope;
+	}
+
+	// the penalty costs of all edges for the given levels
+	double penalty_costs(const std::vector<int>& levels) const;
+
+	// forget the ILP, flow graph, and contracted problem kept for resolve(),
+	// after the problem was changed in a way that resolve() does not track
+	void discard_models();
+
+	// the largest difference between the levels of u and v that the max
+	// gradient g and the level ranges allow
+	int max_difference(NodeId u, NodeId v, int g) const {
+
+		return std::max(std::min(g, std::max(_max_levels[u] - _min_levels[v], _max_levels[v] - _min_levels[u])), 0);
+	}
+
+	// assign the variables for the costs of the penalized edges, starting
+	// with variable number first, returns the number of these variables
+	std::size_t number_penalty_variables(std::size_t first);
+
+	// set the bounds of the variables of the penalized edges
+	void set_penalty_bounds(std::vector<double>& lower_bounds, std::vector<double>& upper_bounds) const;
+
+	// set the variables of the penalized edges in a solution to the
+	// penalties for the given levels per node
+	void set_penalty_variables(const std::vector<int>& levels, Solution& solution) const;
+
+	// generate the constraints that bound the variables of the penalized
+	// edges from below by the linear pieces of their penalties
+	void add_penalty_constraints(const Parameters& parameters, LinearConstraintStream& constraints);
+
+	// add the finite edges and terminal weights for the penalty of the edge
+	// between u and v with max gradient g to the closure graph
+	template <typename FlowType>
+	void add_penalty_edges(FlowType& flow, NodeId u, NodeId v, int g, std::size_t p);
+
+	// merge nodes along zero-gradient edges into the super nodes of
+	// _contracted, returns false if there are no such edges
+	bool contract_zero_gradient_edges();
+
+	// find the minimal surface of the contracted problem
+	double min_surface_contracted(const Parameters& parameters, const std::vector<int>& initial_levels);
+
+	// copy the levels and statistics of _contracted to the original nodes
+	void read_contracted_levels();
+
+	// find the minimal surface by solving an ILP
+	double min_surface_ilp(const Parameters& parameters, const std::vector<int>& initial_levels);
+
+	// convert levels per node into values of the indicator variables x[n,l]
+	Solution indicators(const std::vector<int>& levels) const;
+
+	// find the levels between which the costs of each node are linear, for
+	// the Heights formulation
+	void find_breakpoints();
+
+	// the number of the variable for the fraction of segment k of node n,
+	// between breakpoints k and k+1
+	std::size_t segment_var_num(NodeId n, std::size_t k) const {
+
+		return _num_nodes + _first_breakpoints[n] - n + k;
+	}
+
+	// the costs of the levels in segment k of node n above the level of
+	// breakpoint k
+	double segment_costs(NodeId n, std::size_t k) const {
+
+		const int* breakpoints = &_breakpoints[_first_breakpoints[n]];
+		return _level_costs(n, breakpoints[k + 1]) - _level_costs(n, breakpoints[k]);
+	}
+
+	// whether the slope of the costs decreases at breakpoint k of node n,
+	// i.e., segment k has to be filled after segment k-1
+	bool is_concave_breakpoint(NodeId n, std::size_t k) const;
+
+	// create _solver and pass the objective and constraints of the Heights
+	// formulation
+	void build_height_ilp(const Parameters& parameters);
+
+	// generate the constraints that link the heights and segments of each
+	// node in the Heights formulation
+	void add_segment_constraints(const Parameters& parameters, LinearConstraintStream& constraints);
+
+	// generate the gradient and separation constraints of the Heights
+	// formulation
+	void add_height_gradient_constraints(const Parameters& parameters, LinearConstraintStream& constraints);
+
+	// convert levels per node into values of the variables of the Heights
+	// formulation
+	Solution heights(const std::vector<int>& levels) const;
+
+	// find the range of possible levels for each node within the allowed
+	// ranges, throw if there is no surface with finite costs
+	void find_level_ranges(
+			const Parameters& parameters,
+			std::vector<int>& min_levels,
+			std::vector<int>& max_levels) const;
+
+	// the same as find_level_ranges(), but return false and set
+	// infeasible_node to a node with an empty range instead of throwing
+	bool narrow_level_ranges(
+			const Parameters& parameters,
+			std::vector<int>& min_levels,
+			std::vector<int>& max_levels,
+			NodeId& infeasible_node) const;
+
+	// the value of indicator x[n,l] if it is fixed (0 or 1), -1 if it is a
+	// variable
+	int indicator(NodeId n, int l) const {
+
+		return (l <= _min_levels[n] ? 1 : (l > _max_levels[n] ? 0 : -1));
+	}
+
+	// the number of the variable for indicator x[n,l]
+	std::size_t var_num(NodeId n, int l) const {
+
+		return _first_var_nums[n] + (l - _min_levels[n] - 1);
+	}
+
+	// the costs of the fixed indicators
+	double objective_offset() const;
+
+	// add the constraint x[u,k] <= x[v,l], taking fixed indicators into
+	// account
+	void add_implication(LinearConstraints& constraints, NodeId u, int k, NodeId v, int l) const;
+
+	// add the implications x[u,l] ⇒ x[v,l-d] for the difference constraint
+	// h[u] - h[v] <= d, as far as they are not satisfied by the level ranges
+	void add_difference_implications(LinearConstraints& constraints, NodeId u, NodeId v, int d) const;
+
+	// create _solver and pass the objective and constraints of the ILP, as an
+	// LP if integral_lp is set, returns false if integral_lp is set but
+	// non-difference constraints were added
+	bool build_ilp(const Parameters& parameters, bool integral_lp);
+
+	// check whether the ILP for the given parameters consists of difference
+	// constraints only
+	bool is_difference_system(const Parameters& parameters) const;
+
+	// generate the indicator and column inclusion constraints of the ILP
+	void add_column_constraints(const Parameters& parameters, LinearConstraintStream& constraints);
+
+	// generate the gradient, separation, and zero-minimum constraints of the
+	// ILP
+	void add_surface_constraints(const Parameters& parameters, LinearConstraintStream& constraints);
+
+	// find the minimal surface as a minimal closure via max-flow
+	double min_surface_min_cut(const Parameters& parameters);
+
+	// find the minimal surface on a forest by dynamic programming
+	double min_surface_dp(const Parameters& parameters);
+
+	// build the closure graph in a max-flow solver (MaxFlow or
+	// ParallelMaxFlow)
+	template <typename FlowType>
+	void build_closure_graph(FlowType& flow);
+
+	// add the infinite edges for the difference constraint h[u] - h[v] <= d
+	// to the closure graph
+	template <typename FlowType>
+	void add_difference_edges(FlowType& flow, NodeId u, NodeId v, int d);
+
+	// read the levels from a minimal cut of the closure graph, return the
+	// costs of the surface
+	template <typename FlowType>
+	double read_closure(const FlowType& flow);
+
+	// solve the ILP that was passed to _solver
+	double solve_ilp();
+
 	GraphType _graph;
-	GraphType::NodeMap<std::vector<double>> _level_costs;
+	LevelCosts _level_costs;
 	GraphType::EdgeMap<int> _max_gradients;
 
+	// the penalty of each edge, -1 for edges without one, and the costs of
+	// each penalty for the differences 0,1,..., see add_penalty()
+	GraphType::EdgeMap<int> _penalty_ids;
+	std::vector<std::vector<double>> _penalties;
+
+	// the separation constraints, in the order they were added
+	std::vector<Separation> _separations;
+
 	std::size_t _num_nodes;
 	std::size_t _num_edges;
 	int _num_levels;
 	int _max_gradient;
 
+	// the parameters of the last call to min_surface()
+	Parameters _parameters;
+
+	// the ILP solver backend, if the last call to min_surface() used the Ilp
+	// engine
 	std::unique_ptr<LinearSolverBackend> _solver;
 
-	Solution _solution;
+	// the initial levels of the last call to min_surface() with the Ilp
+	// engine, kept as a start for the ILP if an LP solution is not integral
+	std::vector<int> _initial_levels;
+
+	// the range of allowed levels of each node, see set_level_range()
+	std::vector<int> _first_levels;
+	std::vector<int> _last_levels;
+
+	// the range of levels of each node in the ILP or flow graph, and the
+	// number of the first variable (or flow node) of each node
+	std::vector<int> _min_levels;
+	std::vector<int> _max_levels;
+	std::vector<std::size_t> _first_var_nums;
+
+	// the breakpoints of the costs of each node in the Heights formulation,
+	// _breakpoints[_first_breakpoints[n]],...,_breakpoints[_first_breakpoints[n+1]-1],
+	// and the number of the first binary variable of each node
+	std::vector<std::size_t> _first_breakpoints;
+	std::vector<int> _breakpoints;
+	std::vector<std::size_t> _first_order_var_nums;
+
+	// the number of the variable for the costs of each penalized edge (by
+	// edge id) in either formulation
+	std::vector<std::size_t> _penalty_var_nums;
+
+	// the costs of the fixed indicators, not part of the objective passed to
+	// _solver
+	double _objective_offset;
+
+	// which of the lazily generated constraints (by their position in the
+	// order of generation) were added to _solver
+	std::vector<bool> _lazy_constraints_added;
+
+	// whether _solver holds the ILP as an LP, whose solution has to be
+	// integral
+	bool _integral_lp;
+
+	// statistics about the last solve
+	Statistics _statistics;
+
+	// the closure graph, if the last call to min_surface() used the
+	// single-threaded MinCut engine
+	std::unique_ptr<MaxFlow> _flow;
+
+	// the problem with nodes merged along zero-gradient edges, and the super
+	// node of each node, if the last call to min_surface() contracted
+	// the graph
+	std::unique_ptr<IlpSolver> _contracted;
+	std::vector<NodeId> _super_nodes;
+
+	// nodes whose costs were changed with update_level_costs() since the last
+	// solve
+	std::vector<NodeId> _changed_nodes;
+
+	// the level of each node in the last solution
+	std::vector<int> _levels;
 };
 
 #endif // PYSURFREC_SURFREC_ILP_SOLVER_GRAPH_H__
@@ -0,0 +1,47 @@
+#include <algorithm>
+#include <util/exceptions.h>
+#include "LevelCosts.h"
+
+LevelCosts::LevelCosts(int num_levels, bool single_precision) :
+	_num_levels(num_levels),
+	_single_precision(single_precision),
+	_num_nodes(0) {}
+
+void
+LevelCosts::reserve(std::size_t num_nodes) {
+
+	if (_single_precision)
+		_single_costs.reserve(num_nodes*_num_levels);
+	else
+		_double_costs.reserve(num_nodes*_num_levels);
+}
+
+void
+LevelCosts::resize(std::size_t num_nodes) {
+
+	if (_single_precision)
+		_single_costs.resize(num_nodes*_num_levels, 0.0f);
+	else
+		_double_costs.resize(num_nodes*_num_levels, 0.0);
+
+	_num_nodes = num_nodes;
+}
+
+void
+LevelCosts::set(NodeId n, const std::vector<double>& costs) {
+
+	if (n >= _num_nodes)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"node " << n << " does not exist, there are only " << _num_nodes << " nodes");
+
+	if (costs.size() != static_cast<std::size_t>(_num_levels))
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"expected " << _num_levels << " level costs, got " << costs.size());
+
+	if (_single_precision)
+		std::copy(costs.begin(), costs.end(), _single_costs.begin() + n*_num_levels);
+	else
+		std::copy(costs.begin(), costs.end(), _double_costs.begin() + n*_num_levels);
+}
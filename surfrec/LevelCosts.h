@@ -0,0 +1,178 @@
+#ifndef PYSURFREC_SURFREC_LEVEL_COSTS_H__
+#define PYSURFREC_SURFREC_LEVEL_COSTS_H__
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include <util/exceptions.h>
+
+/**
+ * The level costs of all columns, stored in one contiguous row-major buffer
+ * of num_nodes x num_levels values. Optionally, the costs are stored in
+ * single precision to halve the memory footprint for large volumes.
+ *
+ * Iterating over nodes and levels in increasing order reads the buffer
+ * linearly.
+ */
+class LevelCosts {
+
+public:
+
+	typedef std::size_t NodeId;
+
+	/**
+	 * Create an empty cost buffer for columns with the given number of levels.
+	 *
+	 * @param num_levels
+	 *              The number of levels in each column.
+	 * @param single_precision
+	 *              If set, costs are stored as float instead of double.
+	 */
+	LevelCosts(int num_levels, bool single_precision = false);
+
+	/**
+	 * Reserve memory for the given number of columns.
+	 */
+	void reserve(std::size_t num_nodes);
+
+	/**
+	 * Change the number of columns. New columns have costs of zero.
+	 */
+	void resize(std::size_t num_nodes);
+
+	/**
+	 * Set the costs of all levels of column n.
+	 */
+	void set(NodeId n, const std::vector<double>& costs);
+
+	/**
+	 * Set the costs of the columns first,...,first+num_nodes-1 from a strided
+	 * buffer of values of type T. The costs of level l of column first+i are
+	 * read from data + i*node_stride + l*level_stride (strides in bytes).
+	 * Contiguous rows are copied in one block.
+	 */
+	template <typename T>
+	void set(
+			NodeId first,
+			std::size_t num_nodes,
+			const T* data,
+			std::ptrdiff_t node_stride,
+			std::ptrdiff_t level_stride);
+
+	/**
+	 * The costs of column n at level l.
+	 */
+	inline double operator()(NodeId n, int l) const {
+
+		std::size_t i = n*_num_levels + l;
+		return (_single_precision ? _single_costs[i] : _double_costs[i]);
+	}
+
+	/**
+	 * The difference of the costs of level l to level l-1 in column n (or the
+	 * costs of level 0, if l is 0). These are the objective coefficients of
+	 * the level indicators.
+	 *
+	 * Levels with infinite costs are skipped: their accumulated costs are
+	 * zero, and the ones of the next level with finite costs are relative to
+	 * the last level with finite costs below. The accumulated costs up to a
+	 * level with finite costs thus still sum up to its costs. Levels with
+	 * infinite costs have to be excluded by constraints.
+	 */
+	inline double accumulated(NodeId n, int l) const {
+
+		double costs = (*this)(n, l);
+
+		if (std::isinf(costs))
+			return 0;
+
+		for (int k = l - 1; k >= 0; k--)
+			if (!std::isinf((*this)(n, k)))
+				return costs - (*this)(n, k);
+
+		return costs;
+	}
+
+	std::size_t num_nodes() const { return _num_nodes; }
+
+	int num_levels() const { return _num_levels; }
+
+	bool single_precision() const { return _single_precision; }
+
+private:
+
+	template <typename T, typename Target>
+	void copy(
+			Target* target,
+			std::size_t num_nodes,
+			const T* data,
+			std::ptrdiff_t node_stride,
+			std::ptrdiff_t level_stride);
+
+	int _num_levels;
+
+	bool _single_precision;
+
+	std::size_t _num_nodes;
+
+	// only one of them is used, depending on _single_precision
+	std::vector<double> _double_costs;
+	std::vector<float>  _single_costs;
+};
+
+template <typename T>
+void
+LevelCosts::set(
+		NodeId first,
+		std::size_t num_nodes,
+		const T* data,
+		std::ptrdiff_t node_stride,
+		std::ptrdiff_t level_stride) {
+
+	if (first + num_nodes > _num_nodes)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"can not set costs of nodes " << first << " to " << first + num_nodes - 1 <<
+				", there are only " << _num_nodes << " nodes");
+
+	if (_single_precision)
+		copy(&_single_costs[first*_num_levels], num_nodes, data, node_stride, level_stride);
+	else
+		copy(&_double_costs[first*_num_levels], num_nodes, data, node_stride, level_stride);
+}
+
+template <typename T, typename Target>
+void
+LevelCosts::copy(
+		Target* target,
+		std::size_t num_nodes,
+		const T* data,
+		std::ptrdiff_t node_stride,
+		std::ptrdiff_t level_stride) {
+
+	const char* row = reinterpret_cast<const char*>(data);
+
+	// the whole block is contiguous
+	if (level_stride == sizeof(T) && node_stride == static_cast<std::ptrdiff_t>(_num_levels*sizeof(T))) {
+
+		std::copy(data, data + num_nodes*_num_levels, target);
+		return;
+	}
+
+	for (std::size_t n = 0; n < num_nodes; n++, row += node_stride, target += _num_levels) {
+
+		if (level_stride == sizeof(T)) {
+
+			const T* values = reinterpret_cast<const T*>(row);
+			std::copy(values, values + _num_levels, target);
+
+		} else {
+
+			for (int l = 0; l < _num_levels; l++)
+				target[l] = *reinterpret_cast<const T*>(row + l*level_stride);
+		}
+	}
+}
+
+#endif // PYSURFREC_SURFREC_LEVEL_COSTS_H__
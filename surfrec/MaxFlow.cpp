@@ -0,0 +1,660 @@
+#include <algorithm>
+#include <limits>
+#include <util/exceptions.h>
+#include "MaxFlow.h"
+
+const MaxFlow::ArcId MaxFlow::NoParent;
+const MaxFlow::ArcId MaxFlow::Terminal;
+const MaxFlow::ArcId MaxFlow::Orphan;
+const std::size_t    MaxFlow::None;
+
+MaxFlow::MaxFlow(std::size_t num_nodes, std::size_t num_edges) :
+	_has_trees(false),
+	_time(0),
+	_flow(0) {
+
+	_nodes.reserve(num_nodes);
+	_arcs.reserve(2*num_edges);
+}
+
+MaxFlow::NodeId
+MaxFlow::add_nodes(std::size_t num_nodes) {
+
+	NodeId first = _nodes.size();
+
+	Node node;
+	node.first   = None;
+	node.parent  = NoParent;
+	node.next    = None;
+	node.ts      = 0;
+	node.dist    = 0;
+	node.is_sink   = false;
+	node.is_marked = false;
+	node.tr_cap    = 0;
+
+	_nodes.resize(_nodes.size() + num_nodes, node);
+
+	return first;
+}
+
+void
+MaxFlow::add_edge(NodeId i, NodeId j, double cap, double rev_cap) {
+
+	if (i == j)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"edges in the max-flow graph can not be loops (node " << i << ")");
+
+	ArcId a = _arcs.size();
+
+	Arc forward;
+	forward.head  = j;
+	forward.next  = _nodes[i].first;
+	forward.r_cap = cap;
+
+	Arc backward;
+	backward.head  = i;
+	backward.next  = _nodes[j].first;
+	backward.r_cap = rev_cap;
+
+	_arcs.push_back(forward);
+	_arcs.push_back(backward);
+
+	_nodes[i].first = a;
+	_nodes[j].first = sister(a);
+}
+
+void
+MaxFlow::add_tweights(NodeId i, double cap_source, double cap_sink) {
+
+	double delta = _nodes[i].tr_cap;
+
+	if (delta > 0)
+		cap_source += delta;
+	else
+		cap_sink   -= delta;
+
+	_flow += std::min(cap_source, cap_sink);
+	_nodes[i].tr_cap = cap_source - cap_sink;
+}
+
+bool
+MaxFlow::in_source_segment(NodeId i) const {
+
+	// free nodes (without a parent) are assigned to the source
+	return !(_nodes[i].parent != NoParent && _nodes[i].is_sink);
+}
+
+void
+MaxFlow::mark_node(NodeId i) {
+
+	if (_nodes[i].is_marked)
+		return;
+
+	_nodes[i].is_marked = true;
+	_marked.push_back(i);
+}
+
+double
+MaxFlow::max_flow(bool reuse_trees) {
+
+	if (reuse_trees && _has_trees)
+		reuse_trees_init();
+	else
+		init();
+
+	_has_trees = true;
+
+	NodeId current = None;
+
+	while (true) {
+
+		NodeId i = current;
+
+		// the current node might have been orphaned in the last adoption
+		// stage
+		if (i != None) {
+
+			_nodes[i].next = None;
+			if (_nodes[i].parent == NoParent)
+				i = None;
+		}
+
+		if (i == None) {
+
+			i = next_active();
+			if (i == None)
+				break;
+		}
+
+		// growth stage: look for an arc that connects the source and sink
+		// trees
+
+		Node& node = _nodes[i];
+		ArcId a;
+
+		if (!node.is_sink) {
+
+			for (a = node.first; a != None; a = _arcs[a].next) {
+
+				if (_arcs[a].r_cap <= 0)
+					continue;
+
+				Node& j = _nodes[_arcs[a].head];
+
+				if (j.parent == NoParent) {
+
+					j.is_sink = false;
+					j.parent  = sister(a);
+					j.ts      = node.ts;
+					j.dist    = node.dist + 1;
+					set_active(_arcs[a].head);
+
+				} else if (j.is_sink) {
+
+					break;
+
+				} else if (j.ts <= node.ts && j.dist > node.dist) {
+
+					// heuristic: try to make the distance from j to the
+					// source shorter
+					j.parent = sister(a);
+					j.ts     = node.ts;
+					j.dist   = node.dist + 1;
+				}
+			}
+
+		} else {
+
+			for (a = node.first; a != None; a = _arcs[a].next) {
+
+				if (_arcs[sister(a)].r_cap <= 0)
+					continue;
+
+				Node& j = _nodes[_arcs[a].head];
+
+				if (j.parent == NoParent) {
+
+					j.is_sink = true;
+					j.parent  = sister(a);
+					j.ts      = node.ts;
+					j.dist    = node.dist + 1;
+					set_active(_arcs[a].head);
+
+				} else if (!j.is_sink) {
+
+					// the arc on the path is always directed from the source
+					// to the sink tree
+					a = sister(a);
+					break;
+
+				} else if (j.ts <= node.ts && j.dist > node.dist) {
+
+					j.parent = sister(a);
+					j.ts     = node.ts;
+					j.dist   = node.dist + 1;
+				}
+			}
+		}
+
+		_time++;
+
+		if (a != None) {
+
+			// keep the node active, it might have more paths to offer
+			_nodes[i].next = i;
+			current = i;
+
+			augment(a);
+			adopt_orphans();
+
+		} else {
+
+			current = None;
+		}
+	}
+
+	return _flow;
+}
+
+void
+MaxFlow::init() {
+
+	_queue_first[0] = _queue_last[0] = None;
+	_queue_first[1] = _queue_last[1] = None;
+	_orphans.clear();
+	_marked.clear();
+	_time = 0;
+
+	for (NodeId i = 0; i < _nodes.size(); i++) {
+
+		Node& node = _nodes[i];
+
+		node.next      = None;
+		node.ts        = _time;
+		node.is_marked = false;
+
+		if (node.tr_cap > 0) {
+
+			node.is_sink = false;
+			node.parent  = Terminal;
+			node.dist    = 1;
+			set_active(i);
+
+		} else if (node.tr_cap < 0) {
+
+			node.is_sink = true;
+			node.parent  = Terminal;
+			node.dist    = 1;
+			set_active(i);
+
+		} else {
+
+			node.parent = NoParent;
+		}
+	}
+}
+
+void
+MaxFlow::reuse_trees_init() {
+
+	_queue_first[0] = _queue_last[0] = None;
+	_queue_first[1] = _queue_last[1] = None;
+	_orphans.clear();
+	_time++;
+
+	for (NodeId i : _marked) {
+
+		Node& node = _nodes[i];
+
+		node.is_marked = false;
+		set_active(i);
+
+		if (node.tr_cap == 0) {
+
+			if (node.parent != NoParent)
+				set_orphan_rear(i);
+			continue;
+		}
+
+		if (node.tr_cap > 0) {
+
+			// i has to be in the source tree now
+			if (node.parent == NoParent || node.is_sink) {
+
+				node.is_sink = false;
+
+				for (ArcId a = node.first; a != None; a = _arcs[a].next) {
+
+					Node& j = _nodes[_arcs[a].head];
+
+					if (j.is_marked)
+						continue;
+
+					if (j.parent == sister(a))
+						set_orphan_rear(_arcs[a].head);
+					if (j.parent != NoParent && j.is_sink && _arcs[a].r_cap > 0)
+						set_active(_arcs[a].head);
+				}
+			}
+
+		} else {
+
+			// i has to be in the sink tree now
+			if (node.parent == NoParent || !node.is_sink) {
+
+				node.is_sink = true;
+
+				for (ArcId a = node.first; a != None; a = _arcs[a].next) {
+
+					Node& j = _nodes[_arcs[a].head];
+
+					if (j.is_marked)
+						continue;
+
+					if (j.parent == sister(a))
+						set_orphan_rear(_arcs[a].head);
+					if (j.parent != NoParent && !j.is_sink && _arcs[sister(a)].r_cap > 0)
+						set_active(_arcs[a].head);
+				}
+			}
+		}
+
+		node.parent = Terminal;
+		node.ts     = _time;
+		node.dist   = 1;
+	}
+
+	_marked.clear();
+
+	adopt_orphans();
+}
+
+void
+MaxFlow::set_active(NodeId i) {
+
+	if (_nodes[i].next != None)
+		return;
+
+	if (_queue_last[1] != None)
+		_nodes[_queue_last[1]].next = i;
+	else
+		_queue_first[1] = i;
+
+	_queue_last[1] = i;
+	_nodes[i].next = i;
+}
+
+MaxFlow::NodeId
+MaxFlow::next_active() {
+
+	while (true) {
+
+		NodeId i = _queue_first[0];
+
+		if (i == None) {
+
+			_queue_first[0] = i = _queue_first[1];
+			_queue_last[0]  = _queue_last[1];
+			_queue_first[1] = _queue_last[1] = None;
+
+			if (i == None)
+				return None;
+		}
+
+		// remove i from the active list
+		if (_nodes[i].next == i)
+			_queue_first[0] = _queue_last[0] = None;
+		else
+			_queue_first[0] = _nodes[i].next;
+
+		_nodes[i].next = None;
+
+		// nodes that lost their parent are not active anymore
+		if (_nodes[i].parent != NoParent)
+			return i;
+	}
+}
+
+void
+MaxFlow::set_orphan_front(NodeId i) {
+
+	_nodes[i].parent = Orphan;
+	_orphans.push_front(i);
+}
+
+void
+MaxFlow::set_orphan_rear(NodeId i) {
+
+	_nodes[i].parent = Orphan;
+	_orphans.push_back(i);
+}
+
+void
+MaxFlow::augment(ArcId middle_arc) {
+
+	ArcId a;
+	NodeId i;
+
+	// find the bottleneck capacity
+
+	double bottleneck = _arcs[middle_arc].r_cap;
+
+	// ...in the source tree
+	for (i = _arcs[sister(middle_arc)].head; ; i = _arcs[a].head) {
+
+		a = _nodes[i].parent;
+		if (a == Terminal)
+			break;
+		bottleneck = std::min(bottleneck, _arcs[sister(a)].r_cap);
+	}
+	bottleneck = std::min(bottleneck, _nodes[i].tr_cap);
+
+	// ...in the sink tree
+	for (i = _arcs[middle_arc].head; ; i = _arcs[a].head) {
+
+		a = _nodes[i].parent;
+		if (a == Terminal)
+			break;
+		bottleneck = std::min(bottleneck, _arcs[a].r_cap);
+	}
+	bottleneck = std::min(bottleneck, -_nodes[i].tr_cap);
+
+	// augment along the path
+
+	_arcs[sister(middle_arc)].r_cap += bottleneck;
+	_arcs[middle_arc].r_cap         -= bottleneck;
+
+	// ...in the source tree
+	for (i = _arcs[sister(middle_arc)].head; ; i = _arcs[a].head) {
+
+		a = _nodes[i].parent;
+		if (a == Terminal)
+			break;
+
+		_arcs[a].r_cap         += bottleneck;
+		_arcs[sister(a)].r_cap -= bottleneck;
+
+		if (_arcs[sister(a)].r_cap <= 0)
+			set_orphan_front(i);
+	}
+	_nodes[i].tr_cap -= bottleneck;
+	if (_nodes[i].tr_cap <= 0)
+		set_orphan_front(i);
+
+	// ...in the sink tree
+	for (i = _arcs[middle_arc].head; ; i = _arcs[a].head) {
+
+		a = _nodes[i].parent;
+		if (a == Terminal)
+			break;
+
+		_arcs[sister(a)].r_cap += bottleneck;
+		_arcs[a].r_cap         -= bottleneck;
+
+		if (_arcs[a].r_cap <= 0)
+			set_orphan_front(i);
+	}
+	_nodes[i].tr_cap += bottleneck;
+	if (_nodes[i].tr_cap >= 0)
+		set_orphan_front(i);
+
+	_flow += bottleneck;
+}
+
+void
+MaxFlow::adopt_orphans() {
+
+	while (!_orphans.empty()) {
+
+		NodeId i = _orphans.front();
+		_orphans.pop_front();
+
+		if (_nodes[i].is_sink)
+			process_sink_orphan(i);
+		else
+			process_source_orphan(i);
+	}
+}
+
+void
+MaxFlow::process_source_orphan(NodeId i) {
+
+	const int infinite_dist = std::numeric_limits<int>::max();
+
+	ArcId a0_min = NoParent;
+	int   d_min  = infinite_dist;
+
+	// try to find a new valid parent
+	for (ArcId a0 = _nodes[i].first; a0 != None; a0 = _arcs[a0].next) {
+
+		if (_arcs[sister(a0)].r_cap <= 0)
+			continue;
+
+		NodeId j = _arcs[a0].head;
+		if (_nodes[j].is_sink || _nodes[j].parent == NoParent)
+			continue;
+
+		// check the origin of j
+		int d = 0;
+		while (true) {
+
+			if (_nodes[j].ts == _time) {
+
+				d += _nodes[j].dist;
+				break;
+			}
+
+			ArcId a = _nodes[j].parent;
+			d++;
+
+			if (a == Terminal) {
+
+				_nodes[j].ts   = _time;
+				_nodes[j].dist = 1;
+				break;
+			}
+
+			if (a == Orphan) {
+
+				d = infinite_dist;
+				break;
+			}
+
+			j = _arcs[a].head;
+		}
+
+		if (d < infinite_dist) {
+
+			// j originates from the source
+			if (d < d_min) {
+
+				a0_min = a0;
+				d_min  = d;
+			}
+
+			// set marks along the path
+			for (j = _arcs[a0].head; _nodes[j].ts != _time; j = _arcs[_nodes[j].parent].head) {
+
+				_nodes[j].ts   = _time;
+				_nodes[j].dist = d--;
+			}
+		}
+	}
+
+	_nodes[i].parent = a0_min;
+
+	if (a0_min != NoParent) {
+
+		_nodes[i].ts   = _time;
+		_nodes[i].dist = d_min + 1;
+		return;
+	}
+
+	// no parent found, process the neighbors
+	for (ArcId a0 = _nodes[i].first; a0 != None; a0 = _arcs[a0].next) {
+
+		NodeId j = _arcs[a0].head;
+		ArcId a  = _nodes[j].parent;
+
+		if (_nodes[j].is_sink || a == NoParent)
+			continue;
+
+		if (_arcs[sister(a0)].r_cap > 0)
+			set_active(j);
+
+		if (a != Terminal && a != Orphan && _arcs[a].head == i)
+			set_orphan_rear(j);
+	}
+}
+
+void
+MaxFlow::process_sink_orphan(NodeId i) {
+
+	const int infinite_dist = std::numeric_limits<int>::max();
+
+	ArcId a0_min = NoParent;
+	int   d_min  = infinite_dist;
+
+	// try to find a new valid parent
+	for (ArcId a0 = _nodes[i].first; a0 != None; a0 = _arcs[a0].next) {
+
+		if (_arcs[a0].r_cap <= 0)
+			continue;
+
+		NodeId j = _arcs[a0].head;
+		if (!_nodes[j].is_sink || _nodes[j].parent == NoParent)
+			continue;
+
+		// check the origin of j
+		int d = 0;
+		while (true) {
+
+			if (_nodes[j].ts == _time) {
+
+				d += _nodes[j].dist;
+				break;
+			}
+
+			ArcId a = _nodes[j].parent;
+			d++;
+
+			if (a == Terminal) {
+
+				_nodes[j].ts   = _time;
+				_nodes[j].dist = 1;
+				break;
+			}
+
+			if (a == Orphan) {
+
+				d = infinite_dist;
+				break;
+			}
+
+			j = _arcs[a].head;
+		}
+
+		if (d < infinite_dist) {
+
+			// j originates from the sink
+			if (d < d_min) {
+
+				a0_min = a0;
+				d_min  = d;
+			}
+
+			// set marks along the path
+			for (j = _arcs[a0].head; _nodes[j].ts != _time; j = _arcs[_nodes[j].parent].head) {
+
+				_nodes[j].ts   = _time;
+				_nodes[j].dist = d--;
+			}
+		}
+	}
+
+	_nodes[i].parent = a0_min;
+
+	if (a0_min != NoParent) {
+
+		_nodes[i].ts   = _time;
+		_nodes[i].dist = d_min + 1;
+		return;
+	}
+
+	// no parent found, process the neighbors
+	for (ArcId a0 = _nodes[i].first; a0 != None; a0 = _arcs[a0].next) {
+
+		NodeId j = _arcs[a0].head;
+		ArcId a  = _nodes[j].parent;
+
+		if (!_nodes[j].is_sink || a == NoParent)
+			continue;
+
+		if (_arcs[a0].r_cap > 0)
+			set_active(j);
+
+		if (a != Terminal && a != Orphan && _arcs[a].head == i)
+			set_orphan_rear(j);
+	}
+}
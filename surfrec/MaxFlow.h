@@ -0,0 +1,170 @@
+#ifndef PYSURFREC_SURFREC_MAX_FLOW_H__
+#define PYSURFREC_SURFREC_MAX_FLOW_H__
+
+#include <deque>
+#include <vector>
+
+/**
+ * A max-flow / min-cut solver for directed graphs with source and sink
+ * terminals, implementing the augmenting paths algorithm of Boykov and
+ * Kolmogorov ("An Experimental Comparison of Min-Cut/Max-Flow Algorithms for
+ * Energy Minimization in Vision", PAMI 2004).
+ *
+ * The interface follows the one of Kolmogorov's maxflow library: nodes are
+ * added in bulk, edges are added with a capacity and a reverse capacity, and
+ * terminal edges are set via add_tweights().
+ */
+class MaxFlow {
+
+public:
+
+	typedef std::size_t NodeId;
+
+	/**
+	 * Create a new max-flow graph with memory reserved for the given number of
+	 * nodes and (pairs of) edges.
+	 */
+	MaxFlow(std::size_t num_nodes = 0, std::size_t num_edges = 0);
+
+	/**
+	 * Add n nodes to the graph, return the index to the first one.
+	 */
+	NodeId add_nodes(std::size_t num_nodes);
+
+	/**
+	 * Add a directed edge i->j with capacity cap and the reverse edge j->i
+	 * with capacity rev_cap.
+	 */
+	void add_edge(NodeId i, NodeId j, double cap, double rev_cap);
+
+	/**
+	 * Add capacities to the edges from the source to node i and from node i
+	 * to the sink.
+	 */
+	void add_tweights(NodeId i, double cap_source, double cap_sink);
+
+	/**
+	 * Compute the maximal flow from source to sink. Returns the value of the
+	 * flow, which equals the costs of the minimal cut.
+	 *
+	 * If reuse_trees is set, the search trees and the flow of the previous
+	 * call are reused (Kohli and Torr, "Dynamic Graph Cuts for Efficient
+	 * Inference in Markov Random Fields", PAMI 2007). In this case, all nodes
+	 * whose terminal capacities changed since the last call have to be marked
+	 * with mark_node().
+	 */
+	double max_flow(bool reuse_trees = false);
+
+	/**
+	 * Mark a node whose terminal capacities changed since the last call to
+	 * max_flow().
+	 */
+	void mark_node(NodeId i);
+
+	/**
+	 * After max_flow(), test whether node i is on the source side of the
+	 * minimal cut.
+	 */
+	bool in_source_segment(NodeId i) const;
+
+	/**
+	 * The number of nodes in the graph.
+	 */
+	std::size_t num_nodes() const { return _nodes.size(); }
+
+private:
+
+	typedef std::size_t ArcId;
+
+	// special values for the parent arc of a node
+	static const ArcId NoParent = static_cast<ArcId>(-1);
+	static const ArcId Terminal = static_cast<ArcId>(-2);
+	static const ArcId Orphan   = static_cast<ArcId>(-3);
+
+	// marks the end of a linked list of arcs or nodes
+	static const std::size_t None = static_cast<std::size_t>(-1);
+
+	struct Node {
+
+		// first outgoing arc
+		ArcId first;
+
+		// arc to the parent in the search tree, or one of the special values
+		// above
+		ArcId parent;
+
+		// next node in the active list (points to itself for the last node)
+		NodeId next;
+
+		// timestamp and distance to the terminal, used in the adoption stage
+		int ts;
+		int dist;
+
+		// whether the node belongs to the sink tree
+		bool is_sink;
+
+		// whether the node was marked to be changed
+		bool is_marked;
+
+		// residual capacity of the terminal edge: positive values are
+		// capacities from the source, negative ones to the sink
+		double tr_cap;
+	};
+
+	struct Arc {
+
+		// the node this arc points to
+		NodeId head;
+
+		// next arc with the same tail
+		ArcId next;
+
+		// residual capacity
+		double r_cap;
+	};
+
+	// arcs are created in pairs, such that the reverse of arc a is a^1
+	inline ArcId sister(ArcId a) const { return a^1; }
+
+	void init();
+
+	void reuse_trees_init();
+
+	void set_active(NodeId i);
+
+	NodeId next_active();
+
+	void set_orphan_front(NodeId i);
+
+	void set_orphan_rear(NodeId i);
+
+	void augment(ArcId middle_arc);
+
+	void process_source_orphan(NodeId i);
+
+	void process_sink_orphan(NodeId i);
+
+	void adopt_orphans();
+
+	std::vector<Node> _nodes;
+	std::vector<Arc>  _arcs;
+
+	// two FIFO queues of active nodes, the second one is filled while the
+	// first one is processed
+	NodeId _queue_first[2];
+	NodeId _queue_last[2];
+
+	std::deque<NodeId> _orphans;
+
+	// nodes marked to be changed since the last call to max_flow()
+	std::vector<NodeId> _marked;
+
+	// whether max_flow() was called already, i.e., the search trees are valid
+	bool _has_trees;
+
+	int _time;
+
+	double _flow;
+};
+
+#endif // PYSURFREC_SURFREC_MAX_FLOW_H__
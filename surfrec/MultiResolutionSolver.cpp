@@ -0,0 +1,242 @@
+#include <algorithm>
+#include <util/Logger.h>
+#include <util/exceptions.h>
+#include "MultiResolutionSolver.h"
+
+logger::LogChannel multiresolutionsolverlog("multiresolutionsolverlog", "[MultiResolutionSolver] ");
+
+MultiResolutionSolver::MultiResolutionSolver(
+		const std::vector<std::size_t>& shape,
+		int num_levels,
+		int connectivity,
+		const std::vector<int>& max_gradients) :
+	_shape(shape),
+	_num_levels(num_levels),
+	_connectivity(connectivity),
+	_max_gradients(max_gradients),
+	_num_nodes(GridTopology(shape, connectivity, max_gradients).num_nodes()),
+	_level_costs(_num_nodes*num_levels, 0.0) {
+
+	if (num_levels < 1)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"at least one level is needed, got " << num_levels);
+}
+
+void
+MultiResolutionSolver::set_level_costs(NodeId n, const std::vector<double>& costs) {
+
+	if (n >= _num_nodes)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"node " << n << " is not part of the grid with " << _num_nodes << " nodes");
+
+	if (costs.size() != static_cast<std::size_t>(_num_levels))
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"expected " << _num_levels << " level costs, got " << costs.size());
+
+	std::copy(costs.begin(), costs.end(), _level_costs.begin() + n*_num_levels);
+}
+
+double
+MultiResolutionSolver::min_surface() {
+
+	return min_surface(Parameters());
+}
+
+double
+MultiResolutionSolver::min_surface(const Parameters& parameters) {
+
+	if (parameters.lateral_factor < 1 || parameters.level_factor < 1 || parameters.band < 0)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"the downsampling factors have to be positive and the band non-negative");
+
+	return solve_pyramid(
+			parameters,
+			_shape,
+			_num_levels,
+			_max_gradients,
+			_level_costs,
+			parameters.num_scales,
+			_levels);
+}
+
+int
+MultiResolutionSolver::level(NodeId n) {
+
+	if (n >= _levels.size())
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"no level found for node " << n << ", call min_surface() first");
+
+	return _levels[n];
+}
+
+double
+MultiResolutionSolver::solve_pyramid(
+		const Parameters& parameters,
+		const std::vector<std::size_t>& shape,
+		int num_levels,
+		const std::vector<int>& max_gradients,
+		const std::vector<double>& costs,
+		int num_scales,
+		std::vector<int>& levels) {
+
+	const int lateral_factor = parameters.lateral_factor;
+	const int level_factor   = parameters.level_factor;
+
+	std::vector<std::size_t> coarse_shape(shape.size());
+	std::size_t num_nodes = 1;
+	std::size_t num_coarse_nodes = 1;
+	for (std::size_t d = 0; d < shape.size(); d++) {
+
+		coarse_shape[d] = (shape[d] + lateral_factor - 1)/lateral_factor;
+		num_nodes *= shape[d];
+		num_coarse_nodes *= coarse_shape[d];
+	}
+
+	int num_coarse_levels = (num_levels + level_factor - 1)/level_factor;
+
+	// the coarsest scale, or nothing left to downsample
+	if (num_scales <= 1 || num_coarse_levels < 2 || (num_coarse_nodes == num_nodes && num_coarse_levels == num_levels)) {
+
+		LOG_DEBUG(multiresolutionsolverlog)
+				<< "solving " << num_nodes << " columns with " << num_levels << " levels" << std::endl;
+
+		return solve(parameters, shape, num_levels, max_gradients, costs, std::vector<int>(), std::vector<int>(), levels);
+	}
+
+	// the coarse node of each node, nodes are enumerated in C order
+	std::vector<NodeId> coarse_nodes(num_nodes);
+	std::vector<std::size_t> coords(shape.size(), 0);
+	for (NodeId n = 0; n < num_nodes; n++) {
+
+		NodeId coarse = 0;
+		for (std::size_t d = 0; d < shape.size(); d++)
+			coarse = coarse*coarse_shape[d] + coords[d]/lateral_factor;
+		coarse_nodes[n] = coarse;
+
+		for (std::size_t d = shape.size(); d-- > 0;) {
+
+			if (++coords[d] < shape[d])
+				break;
+			coords[d] = 0;
+		}
+	}
+
+	// sum up the costs of the columns, take the minimum over the levels
+	std::vector<double> coarse_costs(num_coarse_nodes*num_coarse_levels, 0.0);
+	for (NodeId n = 0; n < num_nodes; n++) {
+
+		const double* column = &costs[n*num_levels];
+		double* coarse_column = &coarse_costs[coarse_nodes[n]*num_coarse_levels];
+
+		for (int l = 0; l < num_coarse_levels; l++)
+			coarse_column[l] += *std::min_element(
+					column + l*level_factor,
+					column + std::min((l + 1)*level_factor, num_levels));
+	}
+
+	// a gradient of g between neighboring nodes allows a gradient of about
+	// g*lateral_factor/level_factor between coarse nodes
+	std::vector<int> coarse_max_gradients(max_gradients.size());
+	for (std::size_t i = 0; i < max_gradients.size(); i++)
+		coarse_max_gradients[i] = (max_gradients[i]*lateral_factor + level_factor - 1)/level_factor;
+
+	std::vector<int> coarse_levels;
+	solve_pyramid(
+			parameters,
+			coarse_shape,
+			num_coarse_levels,
+			coarse_max_gradients,
+			coarse_costs,
+			num_scales - 1,
+			coarse_levels);
+
+	// The upsampled coarse surface might violate the gradient constraints
+	// between the blocks of nodes. Lower it until it does not, such that the
+	// band around it contains at least one surface.
+	GridTopology topology(shape, _connectivity, max_gradients);
+
+	std::vector<int> lower(num_nodes);
+	for (NodeId n = 0; n < num_nodes; n++)
+		lower[n] = coarse_levels[coarse_nodes[n]]*level_factor;
+
+	bool changed = true;
+	while (changed) {
+
+		changed = false;
+		topology.for_each_edge([&](NodeId u, NodeId v, int g) {
+
+			if (lower[u] > lower[v] + g) {
+
+				lower[u] = lower[v] + g;
+				changed = true;
+			}
+			if (lower[v] > lower[u] + g) {
+
+				lower[v] = lower[u] + g;
+				changed = true;
+			}
+		});
+	}
+
+	// the band covers all levels of the coarse level of each node
+	std::vector<int> min_levels(num_nodes);
+	std::vector<int> max_levels(num_nodes);
+	for (NodeId n = 0; n < num_nodes; n++) {
+
+		min_levels[n] = std::max(lower[n] - parameters.band, 0);
+		max_levels[n] = std::min(lower[n] + level_factor - 1 + parameters.band, num_levels - 1);
+	}
+
+	LOG_DEBUG(multiresolutionsolverlog)
+			<< "solving " << num_nodes << " columns with " << num_levels << " levels in a band of "
+			<< (level_factor + 2*parameters.band) << " levels" << std::endl;
+
+	return solve(parameters, shape, num_levels, max_gradients, costs, min_levels, max_levels, levels);
+}
+
+double
+MultiResolutionSolver::solve(
+		const Parameters& parameters,
+		const std::vector<std::size_t>& shape,
+		int num_levels,
+		const std::vector<int>& max_gradients,
+		const std::vector<double>& costs,
+		const std::vector<int>& min_levels,
+		const std::vector<int>& max_levels,
+		std::vector<int>& levels) {
+
+	GridTopology topology(shape, _connectivity, max_gradients);
+	const std::size_t num_nodes = topology.num_nodes();
+
+	IlpSolver solver(num_nodes, topology.num_edges(), num_levels, max_gradients[0]);
+	solver.add_nodes(num_nodes);
+	solver.add_grid_edges(shape, _connectivity, max_gradients);
+
+	solver.set_level_costs(0, num_nodes, costs.data(), num_levels*sizeof(double), sizeof(double));
+
+	if (!min_levels.empty())
+		for (NodeId n = 0; n < num_nodes; n++)
+			solver.set_level_range(n, min_levels[n], max_levels[n]);
+
+	// the band can be infeasible, e.g., due to infinite costs within it or
+	// gradient constraints that can not be satisfied
+	if (!min_levels.empty() && !solver.has_feasible_surface()) {
+
+		LOG_USER(multiresolutionsolverlog)
+				<< "no surface found within the band, solving without it" << std::endl;
+
+		return solve(parameters, shape, num_levels, max_gradients, costs, std::vector<int>(), std::vector<int>(), levels);
+	}
+
+	double value = solver.min_surface(parameters.solver_parameters);
+
+	levels = solver.levels();
+	_statistics = solver.statistics();
+
+	return value;
+}
@@ -0,0 +1,151 @@
+#ifndef PYSURFREC_SURFREC_MULTI_RESOLUTION_SOLVER_H__
+#define PYSURFREC_SURFREC_MULTI_RESOLUTION_SOLVER_H__
+
+#include <vector>
+#include "GridTopology.h"
+#include "IlpSolver.h"
+
+/**
+ * A coarse-to-fine surface solver for regular 2D and 3D grids. The level
+ * costs are downsampled along the axes of the grid and along the levels into
+ * a pyramid of coarser problems. The coarsest problem is solved with
+ * IlpSolver, and each finer problem only inside a band of levels around the
+ * upsampled surface of the next coarser one. The result is not guaranteed to
+ * be the minimal surface, but usually is for smooth surfaces, at a fraction
+ * of the variables.
+ */
+class MultiResolutionSolver {
+
+public:
+
+	typedef GridTopology::NodeId NodeId;
+
+	struct Parameters {
+
+		Parameters() :
+			num_scales(3),
+			lateral_factor(2),
+			level_factor(2),
+			band(2) {}
+
+		/**
+		 * The number of scales of the pyramid, including the original
+		 * problem. Fewer scales are used if the grid or the number of levels
+		 * get too small to be downsampled again.
+		 */
+		int num_scales;
+
+		/**
+		 * The downsampling factor along each axis of the grid between two
+		 * scales. The costs of a coarse column are the sums of the costs of
+		 * the columns it covers.
+		 */
+		int lateral_factor;
+
+		/**
+		 * The downsampling factor of the levels between two scales. The
+		 * costs of a coarse level are the minimal costs of the levels it
+		 * covers.
+		 */
+		int level_factor;
+
+		/**
+		 * The number of levels by which the band around the upsampled coarse
+		 * surface is extended below and above.
+		 */
+		int band;
+
+		/**
+		 * The parameters for solving the problem at each scale. The band is
+		 * passed as level ranges to IlpSolver, such that only levels inside
+		 * of it become part of the flow graph or the ILP.
+		 */
+		IlpSolver::Parameters solver_parameters;
+	};
+
+	/**
+	 * Create a new solver for a grid of the given shape. See
+	 * GridSurfaceSolver for the meaning of the arguments.
+	 */
+	MultiResolutionSolver(
+			const std::vector<std::size_t>& shape,
+			int num_levels,
+			int connectivity,
+			const std::vector<int>& max_gradients);
+
+	/**
+	 * The number of nodes (columns) in the grid.
+	 */
+	std::size_t num_nodes() const { return _num_nodes; }
+
+	/**
+	 * Set the costs for passing the surface through the different levels of a
+	 * column.
+	 */
+	void set_level_costs(NodeId n, const std::vector<double>& costs);
+
+	/**
+	 * Find the cost-minimal surface, coarse-to-fine.
+	 */
+	double min_surface();
+	double min_surface(const Parameters& parameters);
+
+	/**
+	 * Return the level where the found surface passes through the column of
+	 * node n.
+	 */
+	int level(NodeId n);
+
+	/**
+	 * The levels of all nodes found by the last call to min_surface().
+	 */
+	const std::vector<int>& levels() const { return _levels; }
+
+	/**
+	 * Statistics about solving the original problem in the last call to
+	 * min_surface().
+	 */
+	const IlpSolver::Statistics& statistics() const { return _statistics; }
+
+private:
+
+	// find the surface for the given scale of the pyramid and all coarser
+	// ones, with costs row-major num_nodes x num_levels, returns the costs of
+	// the surface
+	double solve_pyramid(
+			const Parameters& parameters,
+			const std::vector<std::size_t>& shape,
+			int num_levels,
+			const std::vector<int>& max_gradients,
+			const std::vector<double>& costs,
+			int num_scales,
+			std::vector<int>& levels);
+
+	// solve the problem for one scale, only considering levels within the
+	// given ranges (if not empty)
+	double solve(
+			const Parameters& parameters,
+			const std::vector<std::size_t>& shape,
+			int num_levels,
+			const std::vector<int>& max_gradients,
+			const std::vector<double>& costs,
+			const std::vector<int>& min_levels,
+			const std::vector<int>& max_levels,
+			std::vector<int>& levels);
+
+	std::vector<std::size_t> _shape;
+	int _num_levels;
+	int _connectivity;
+	std::vector<int> _max_gradients;
+
+	std::size_t _num_nodes;
+
+	// the level costs of all columns, row-major num_nodes x num_levels
+	std::vector<double> _level_costs;
+
+	IlpSolver::Statistics _statistics;
+
+	std::vector<int> _levels;
+};
+
+#endif // PYSURFREC_SURFREC_MULTI_RESOLUTION_SOLVER_H__
@@ -0,0 +1,210 @@
+#include <algorithm>
+#include <util/Logger.h>
+#include <util/exceptions.h>
+#include "GridTopology.h"
+#include "MultiSurfaceSolver.h"
+
+logger::LogChannel multisurfacesolverlog("multisurfacesolverlog", "[MultiSurfaceSolver] ");
+
+MultiSurfaceSolver::MultiSurfaceSolver(
+		std::size_t num_nodes,
+		std::size_t num_edges,
+		int num_surfaces,
+		int num_levels,
+		int max_gradient) :
+	_num_nodes(0),
+	_num_surfaces(num_surfaces),
+	_num_levels(num_levels),
+	_max_gradient(max_gradient) {
+
+	if (num_surfaces < 1)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"at least one surface is needed, got " << num_surfaces);
+
+	if (num_levels < 1)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"at least one level is needed, got " << num_levels);
+
+	_edges.reserve(num_edges);
+	_level_costs.reserve(num_nodes*num_surfaces*num_levels);
+}
+
+MultiSurfaceSolver::NodeId
+MultiSurfaceSolver::add_nodes(std::size_t num_nodes) {
+
+	NodeId first = _num_nodes;
+
+	_num_nodes += num_nodes;
+	_level_costs.resize(_num_nodes*_num_surfaces*_num_levels, 0.0);
+
+	return first;
+}
+
+void
+MultiSurfaceSolver::add_edge(NodeId u, NodeId v) {
+
+	add_edge(u, v, _max_gradient);
+}
+
+void
+MultiSurfaceSolver::add_edge(NodeId u, NodeId v, int g) {
+
+	if (u >= _num_nodes || v >= _num_nodes)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"can not add edge (" << u << ", " << v << "), there are only " << _num_nodes << " nodes");
+
+	if (g < 0)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"the max gradient of edge (" << u << ", " << v << ") is negative");
+
+	_edges.push_back(std::make_tuple(u, v, g));
+}
+
+void
+MultiSurfaceSolver::add_grid_edges(
+		const std::vector<std::size_t>& shape,
+		int connectivity,
+		const std::vector<int>& max_gradients,
+		const std::vector<bool>& wrap_around) {
+
+	GridTopology grid(shape, connectivity, max_gradients, wrap_around);
+
+	if (grid.num_nodes() != _num_nodes)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"the grid has " << grid.num_nodes() << " nodes, but " << _num_nodes << " nodes were added");
+
+	_edges.reserve(_edges.size() + grid.num_edges());
+	grid.for_each_edge([&](NodeId u, NodeId v, int g) {
+
+		_edges.push_back(std::make_tuple(u, v, g));
+	});
+}
+
+void
+MultiSurfaceSolver::set_level_costs(int surface, NodeId n, const std::vector<double>& costs) {
+
+	check_surface(surface);
+
+	if (n >= _num_nodes)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"node " << n << " does not exist, there are only " << _num_nodes << " nodes");
+
+	if (costs.size() != static_cast<std::size_t>(_num_levels))
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"expected " << _num_levels << " level costs, got " << costs.size());
+
+	std::copy(costs.begin(), costs.end(), _level_costs.begin() + (n*_num_surfaces + surface)*_num_levels);
+}
+
+void
+MultiSurfaceSolver::set_separation(int lower, int upper, int min_separation, int max_separation) {
+
+	check_surface(lower);
+	check_surface(upper);
+
+	if (lower == upper)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"can not set a separation between surface " << lower << " and itself");
+
+	if (min_separation > max_separation)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"the min separation " << min_separation << " of surfaces " << lower << " and " << upper <<
+				" is larger than the max separation " << max_separation);
+
+	Separation separation;
+	separation.lower = lower;
+	separation.upper = upper;
+	separation.min_separation = min_separation;
+	separation.max_separation = max_separation;
+
+	for (Separation& s : _separations) {
+
+		if (s.lower == lower && s.upper == upper) {
+
+			s = separation;
+			return;
+		}
+	}
+
+	_separations.push_back(separation);
+}
+
+double
+MultiSurfaceSolver::min_surface() {
+
+	return min_surface(IlpSolver::Parameters());
+}
+
+double
+MultiSurfaceSolver::min_surface(const IlpSolver::Parameters& parameters) {
+
+	// surface s in the column of node n is node n*_num_surfaces + s of the
+	// solver, which matches the layout of the level costs
+	const std::size_t num_surfaces = _num_surfaces;
+
+	IlpSolver solver(_num_nodes*num_surfaces, _edges.size()*num_surfaces, _num_levels, _max_gradient);
+	solver.add_nodes(_num_nodes*num_surfaces);
+	solver.set_level_costs(
+			0,
+			_num_nodes*num_surfaces,
+			_level_costs.data(),
+			_num_levels*sizeof(double),
+			sizeof(double));
+
+	for (const auto& edge : _edges)
+		for (std::size_t s = 0; s < num_surfaces; s++)
+			solver.add_edge(
+					std::get<0>(edge)*num_surfaces + s,
+					std::get<1>(edge)*num_surfaces + s,
+					std::get<2>(edge));
+
+	for (NodeId n = 0; n < _num_nodes; n++)
+		for (const Separation& separation : _separations)
+			solver.add_separation(
+					n*num_surfaces + separation.lower,
+					n*num_surfaces + separation.upper,
+					separation.min_separation,
+					separation.max_separation);
+
+	LOG_DEBUG(multisurfacesolverlog)
+			<< "finding " << num_surfaces << " surfaces through " << _num_nodes << " columns with "
+			<< _separations.size() << " separations per column" << std::endl;
+
+	double value = solver.min_surface(parameters);
+
+	_levels = solver.levels();
+	_statistics = solver.statistics();
+
+	return value;
+}
+
+int
+MultiSurfaceSolver::level(int surface, NodeId n) {
+
+	check_surface(surface);
+
+	if (n*_num_surfaces + surface >= _levels.size())
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"no level found for node " << n << ", call min_surface() first");
+
+	return _levels[n*_num_surfaces + surface];
+}
+
+void
+MultiSurfaceSolver::check_surface(int surface) const {
+
+	if (surface < 0 || surface >= _num_surfaces)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"surface " << surface << " does not exist, there are only " << _num_surfaces << " surfaces");
+}
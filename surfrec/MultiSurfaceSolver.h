@@ -0,0 +1,148 @@
+#ifndef PYSURFREC_SURFREC_MULTI_SURFACE_SOLVER_H__
+#define PYSURFREC_SURFREC_MULTI_SURFACE_SOLVER_H__
+
+#include <tuple>
+#include <vector>
+#include "IlpSolver.h"
+
+/**
+ * A solver for several surfaces through the same columns (e.g., the inner and
+ * outer boundary of a layer), which are found jointly in a single solve. Each
+ * surface has its own level costs and shares the graph and max gradients of
+ * the others. Pairs of surfaces can be kept apart by a minimal and maximal
+ * separation in every column.
+ *
+ * Internally, each column is represented by one IlpSolver node per surface,
+ * such that all engines of IlpSolver that support separation constraints can
+ * be used.
+ */
+class MultiSurfaceSolver {
+
+public:
+
+	typedef IlpSolver::NodeId NodeId;
+
+	/**
+	 * Create a new solver for the given estimated number of nodes and edges
+	 * (per surface). See IlpSolver for the meaning of the arguments.
+	 *
+	 * @param num_surfaces
+	 *              The number of surfaces to find.
+	 */
+	MultiSurfaceSolver(
+			std::size_t num_nodes,
+			std::size_t num_edges,
+			int num_surfaces,
+			int num_levels,
+			int max_gradient);
+
+	/**
+	 * Add n nodes (columns) to the graph, return the index to the first one.
+	 */
+	NodeId add_nodes(std::size_t num_nodes);
+
+	/**
+	 * Add a neighborhood edge between nodes u and v, for all surfaces. See
+	 * IlpSolver::add_edge().
+	 */
+	void add_edge(NodeId u, NodeId v);
+	void add_edge(NodeId u, NodeId v, int max_gradient);
+
+	/**
+	 * Add the edges of a regular lattice, for all surfaces. See
+	 * IlpSolver::add_grid_edges().
+	 */
+	void add_grid_edges(
+			const std::vector<std::size_t>& shape,
+			int connectivity,
+			const std::vector<int>& max_gradients,
+			const std::vector<bool>& wrap_around = std::vector<bool>());
+
+	/**
+	 * Set the costs for passing the given surface through the different
+	 * levels of the column of node n. Columns without costs set have costs of
+	 * zero.
+	 */
+	void set_level_costs(int surface, NodeId n, const std::vector<double>& costs);
+
+	/**
+	 * Require surface upper to pass through each column at least
+	 * min_separation and at most max_separation levels above surface lower.
+	 * Replaces the separation previously set for the same pair of surfaces.
+	 * Surfaces without a separation between them are independent.
+	 */
+	void set_separation(int lower, int upper, int min_separation, int max_separation);
+
+	/**
+	 * The number of nodes (columns) added so far.
+	 */
+	std::size_t num_nodes() const { return _num_nodes; }
+
+	/**
+	 * The number of surfaces.
+	 */
+	int num_surfaces() const { return _num_surfaces; }
+
+	/**
+	 * The number of levels in each column.
+	 */
+	int num_levels() const { return _num_levels; }
+
+	/**
+	 * Find the surfaces with minimal total costs that satisfy the gradient
+	 * and separation constraints. Throws an Exception if there are none. The
+	 * DynamicProgramming engine is not supported.
+	 */
+	double min_surface();
+	double min_surface(const IlpSolver::Parameters& parameters);
+
+	/**
+	 * Return the level where the given surface passes through the column of
+	 * node n.
+	 */
+	int level(int surface, NodeId n);
+
+	/**
+	 * The levels of all surfaces found by the last call to min_surface(),
+	 * the level of surface s in the column of node n is at index
+	 * n*num_surfaces() + s.
+	 */
+	const std::vector<int>& levels() const { return _levels; }
+
+	/**
+	 * Statistics about the last call to min_surface().
+	 */
+	const IlpSolver::Statistics& statistics() const { return _statistics; }
+
+private:
+
+	struct Separation {
+
+		int lower;
+		int upper;
+		int min_separation;
+		int max_separation;
+	};
+
+	void check_surface(int surface) const;
+
+	std::size_t _num_nodes;
+	int _num_surfaces;
+	int _num_levels;
+	int _max_gradient;
+
+	// the edges between columns with their max gradients
+	std::vector<std::tuple<NodeId, NodeId, int>> _edges;
+
+	// the level costs of all surfaces, the costs of surface s in the column
+	// of node n start at (n*_num_surfaces + s)*_num_levels
+	std::vector<double> _level_costs;
+
+	std::vector<Separation> _separations;
+
+	IlpSolver::Statistics _statistics;
+
+	std::vector<int> _levels;
+};
+
+#endif // PYSURFREC_SURFREC_MULTI_SURFACE_SOLVER_H__
@@ -0,0 +1,484 @@
+#include <algorithm>
+#include <thread>
+#include <util/exceptions.h>
+#include "ParallelMaxFlow.h"
+
+void
+ParallelMaxFlow::Barrier::wait() {
+
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	unsigned long generation = _generation;
+
+	if (++_waiting == _num_threads) {
+
+		_waiting = 0;
+		_generation++;
+		_condition.notify_all();
+
+	} else {
+
+		_condition.wait(lock, [&]{ return generation != _generation; });
+	}
+}
+
+ParallelMaxFlow::ParallelMaxFlow(std::size_t num_nodes, std::size_t num_edges, int num_threads) :
+	_num_threads(std::max(num_threads, 1)),
+	_infinite_label(0),
+	_barrier(std::max(num_threads, 1)),
+	_done(false),
+	_do_global_relabel(true),
+	_work_since_global_relabel(0),
+	_flow(0) {
+
+	_excess.reserve(num_nodes);
+	_sink_cap.reserve(num_nodes);
+	_edges.reserve(num_edges);
+}
+
+ParallelMaxFlow::NodeId
+ParallelMaxFlow::add_nodes(std::size_t num_nodes) {
+
+	NodeId first = _excess.size();
+
+	_excess.resize(first + num_nodes, 0.0);
+	_sink_cap.resize(first + num_nodes, 0.0);
+
+	return first;
+}
+
+void
+ParallelMaxFlow::add_edge(NodeId i, NodeId j, double cap, double rev_cap) {
+
+	if (i == j)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"edges in the max-flow graph can not be loops (node " << i << ")");
+
+	Edge edge;
+	edge.i       = i;
+	edge.j       = j;
+	edge.cap     = cap;
+	edge.rev_cap = rev_cap;
+
+	_edges.push_back(edge);
+}
+
+void
+ParallelMaxFlow::add_tweights(NodeId i, double cap_source, double cap_sink) {
+
+	// the excess of a node is the net capacity from the source, the rest
+	// is sent to the sink directly
+	double tr_cap = _excess[i] - _sink_cap[i] + cap_source - cap_sink;
+	_flow += std::min(cap_source, cap_sink);
+
+	_excess[i]   = std::max(tr_cap, 0.0);
+	_sink_cap[i] = std::max(-tr_cap, 0.0);
+}
+
+double
+ParallelMaxFlow::max_flow() {
+
+	build_arcs();
+
+	const std::size_t num_nodes = _excess.size();
+
+	_infinite_label = num_nodes + 1;
+	_label.assign(num_nodes, 0);
+
+	std::vector<std::atomic<unsigned char>> flags(num_nodes);
+	for (auto& flag : flags)
+		flag = 0;
+	_flags.swap(flags);
+
+	color_regions();
+
+	_outboxes.assign(_num_threads, std::vector<std::pair<NodeId, double>>());
+	_thread_lists.assign(_num_threads, std::vector<NodeId>());
+	_thread_flow.assign(_num_threads, 0.0);
+	_thread_work.assign(_num_threads, 0);
+
+	_next_region = 0;
+	_done = false;
+	_do_global_relabel = true;
+	_work_since_global_relabel = 0;
+
+	std::vector<std::thread> threads;
+	for (int t = 1; t < _num_threads; t++)
+		threads.push_back(std::thread(&ParallelMaxFlow::work, this, t));
+	work(0);
+	for (std::thread& thread : threads)
+		thread.join();
+
+	for (double flow : _thread_flow)
+		_flow += flow;
+
+	return _flow;
+}
+
+void
+ParallelMaxFlow::build_arcs() {
+
+	const std::size_t num_nodes = _excess.size();
+
+	// count the arcs of each node
+	_first_arc.assign(num_nodes + 1, 0);
+	for (const Edge& edge : _edges) {
+
+		_first_arc[edge.i + 1]++;
+		_first_arc[edge.j + 1]++;
+	}
+	for (std::size_t i = 0; i < num_nodes; i++)
+		_first_arc[i + 1] += _first_arc[i];
+
+	const std::size_t num_arcs = _first_arc[num_nodes];
+	_head.resize(num_arcs);
+	_sister.resize(num_arcs);
+	_r_cap.resize(num_arcs);
+
+	std::vector<ArcId> next_arc(_first_arc.begin(), _first_arc.end() - 1);
+	for (const Edge& edge : _edges) {
+
+		ArcId a = next_arc[edge.i]++;
+		ArcId b = next_arc[edge.j]++;
+
+		_head[a]   = edge.j;
+		_head[b]   = edge.i;
+		_sister[a] = b;
+		_sister[b] = a;
+		_r_cap[a]  = edge.cap;
+		_r_cap[b]  = edge.rev_cap;
+	}
+
+	// the edges are not needed anymore
+	std::vector<Edge>().swap(_edges);
+}
+
+void
+ParallelMaxFlow::color_regions() {
+
+	const std::size_t num_nodes = _excess.size();
+
+	// a few regions per thread, such that threads that finish early can take
+	// another region of the same color
+	_num_regions = (_num_threads > 1 ? 8*_num_threads : 1);
+	_num_regions = std::max<std::size_t>(std::min(_num_regions, num_nodes), 1);
+	_region_size = std::max<std::size_t>((num_nodes + _num_regions - 1)/_num_regions, 1);
+	_num_regions = std::max<std::size_t>((num_nodes + _region_size - 1)/_region_size, 1);
+
+	_region_active.assign(_num_regions, std::vector<NodeId>());
+
+	// the adjacent regions of each region
+	std::vector<std::vector<std::size_t>> neighbors(_num_regions);
+	for (NodeId i = 0; i < num_nodes; i++)
+		for (ArcId a = _first_arc[i]; a < _first_arc[i + 1]; a++)
+			if (region(_head[a]) != region(i))
+				neighbors[region(i)].push_back(region(_head[a]));
+
+	// greedy coloring in the order of the regions
+	std::vector<int> colors(_num_regions, -1);
+	std::vector<bool> used;
+	_color_regions.clear();
+
+	for (std::size_t r = 0; r < _num_regions; r++) {
+
+		used.assign(_color_regions.size() + 1, false);
+		for (std::size_t s : neighbors[r])
+			if (colors[s] >= 0)
+				used[colors[s]] = true;
+
+		int color = 0;
+		while (used[color])
+			color++;
+
+		colors[r] = color;
+		if (color == static_cast<int>(_color_regions.size()))
+			_color_regions.push_back(std::vector<std::size_t>());
+		_color_regions[color].push_back(r);
+	}
+}
+
+void
+ParallelMaxFlow::work(int thread) {
+
+	while (true) {
+
+		if (_do_global_relabel)
+			global_relabel(thread);
+
+		if (_done)
+			break;
+
+		for (const std::vector<std::size_t>& regions : _color_regions) {
+
+			// regions of the same color do not share arcs and can be
+			// discharged in parallel
+			for (std::size_t i = _next_region++; i < regions.size(); i = _next_region++)
+				discharge_region(regions[i], thread);
+
+			_barrier.wait();
+
+			if (thread == 0) {
+
+				empty_outboxes();
+				_next_region = 0;
+			}
+
+			_barrier.wait();
+		}
+
+		if (thread == 0) {
+
+			for (std::size_t& work : _thread_work) {
+
+				_work_since_global_relabel += work;
+				work = 0;
+			}
+
+			bool active = false;
+			for (const std::vector<NodeId>& nodes : _region_active)
+				active = active || !nodes.empty();
+
+			// Without active nodes, we compute the final distance labels to
+			// find the minimal cut. This might activate nodes again, if the
+			// labels were not exact.
+			_do_global_relabel =
+					!active ||
+					_work_since_global_relabel > 6*_excess.size() + _head.size();
+		}
+
+		_barrier.wait();
+	}
+}
+
+void
+ParallelMaxFlow::discharge_region(std::size_t r, int thread) {
+
+	// work on a local copy of the active nodes (to which nodes of the region
+	// activated during the discharge are appended), and local counters, to
+	// not share cache lines with other threads
+	std::vector<NodeId> active;
+	active.swap(_region_active[r]);
+	std::size_t work = 0;
+	double flow = 0;
+
+	// stop after the region's share of the work between two global
+	// relabelings, the remaining nodes stay active
+	const std::size_t budget = (6*_excess.size() + _head.size())/_num_regions + 1;
+
+	std::size_t i = 0;
+	for (; i < active.size() && work < budget; i++) {
+
+		NodeId u = active[i];
+		_flags[u] = 0;
+
+		work += discharge(u, r, active, flow, thread);
+	}
+
+	active.erase(active.begin(), active.begin() + i);
+	active.swap(_region_active[r]);
+
+	_thread_work[thread] += work;
+	_thread_flow[thread] += flow;
+}
+
+std::size_t
+ParallelMaxFlow::discharge(NodeId u, std::size_t r, std::vector<NodeId>& active, double& flow, int thread) {
+
+	double excess = _excess[u];
+	std::size_t work = 0;
+
+	while (excess > 0 && _label[u] < _infinite_label) {
+
+		const int label = _label[u];
+		int min_label = _infinite_label - 1;
+
+		if (_sink_cap[u] > 0) {
+
+			if (label == 1) {
+
+				double delta = std::min(excess, _sink_cap[u]);
+
+				_sink_cap[u] -= delta;
+				excess -= delta;
+				flow += delta;
+			}
+
+			if (_sink_cap[u] > 0)
+				min_label = 0;
+		}
+
+		for (ArcId a = _first_arc[u]; a < _first_arc[u + 1]; a++) {
+
+			if (_r_cap[a] <= 0)
+				continue;
+
+			NodeId v = _head[a];
+
+			if (excess > 0 && _label[v] == label - 1) {
+
+				double delta = std::min(excess, _r_cap[a]);
+
+				// the sister belongs to v, whose region is not processed
+				// in parallel
+				_r_cap[a]          -= delta;
+				_r_cap[_sister[a]] += delta;
+				excess             -= delta;
+
+				if (region(v) == r) {
+
+					_excess[v] += delta;
+
+					if (!_flags[v] && _label[v] < _infinite_label) {
+
+						_flags[v] = 1;
+						active.push_back(v);
+					}
+
+				} else {
+
+					_outboxes[thread].push_back(std::make_pair(v, delta));
+				}
+			}
+
+			if (_r_cap[a] > 0)
+				min_label = std::min(min_label, _label[v]);
+		}
+
+		work += _first_arc[u + 1] - _first_arc[u] + 1;
+
+		if (excess <= 0)
+			break;
+
+		_label[u] = min_label + 1;
+	}
+
+	_excess[u] = excess;
+
+	return work;
+}
+
+void
+ParallelMaxFlow::empty_outboxes() {
+
+	for (std::vector<std::pair<NodeId, double>>& outbox : _outboxes) {
+
+		for (const std::pair<NodeId, double>& pushed : outbox) {
+
+			NodeId v = pushed.first;
+			_excess[v] += pushed.second;
+
+			if (!_flags[v] && _excess[v] > 0 && _label[v] < _infinite_label) {
+
+				_flags[v] = 1;
+				_region_active[region(v)].push_back(v);
+			}
+		}
+
+		outbox.clear();
+	}
+}
+
+void
+ParallelMaxFlow::global_relabel(int thread) {
+
+	// start with the nodes connected to the sink, the active lists are
+	// rebuilt below
+
+	for (std::size_t r = chunk_begin(_num_regions, thread); r < chunk_end(_num_regions, thread); r++) {
+
+		_region_active[r].clear();
+
+		for (NodeId i = r*_region_size; i < std::min((r + 1)*_region_size, _excess.size()); i++) {
+
+			if (_sink_cap[i] > 0) {
+
+				_label[i] = 1;
+				_flags[i] = 1;
+				_thread_lists[thread].push_back(i);
+
+			} else {
+
+				_label[i] = _infinite_label;
+				_flags[i] = 0;
+			}
+		}
+	}
+
+	_barrier.wait();
+
+	if (thread == 0)
+		concatenate(_thread_lists, _frontier);
+
+	_barrier.wait();
+
+	// breadth-first search on the reverse residual graph
+
+	while (!_frontier.empty()) {
+
+		for (std::size_t i = chunk_begin(_frontier.size(), thread); i < chunk_end(_frontier.size(), thread); i++) {
+
+			NodeId v = _frontier[i];
+
+			for (ArcId a = _first_arc[v]; a < _first_arc[v + 1]; a++) {
+
+				NodeId w = _head[a];
+
+				if (_r_cap[_sister[a]] > 0 && !_flags[w].exchange(1)) {
+
+					_label[w] = _label[v] + 1;
+					_thread_lists[thread].push_back(w);
+				}
+			}
+		}
+
+		_barrier.wait();
+
+		if (thread == 0)
+			concatenate(_thread_lists, _frontier);
+
+		_barrier.wait();
+	}
+
+	// reset the flags and find the active nodes of each region
+
+	for (std::size_t r = chunk_begin(_num_regions, thread); r < chunk_end(_num_regions, thread); r++)
+		for (NodeId i = r*_region_size; i < std::min((r + 1)*_region_size, _excess.size()); i++) {
+
+			_flags[i] = (_excess[i] > 0 && _label[i] < _infinite_label);
+
+			if (_flags[i])
+				_region_active[r].push_back(i);
+		}
+
+	_barrier.wait();
+
+	if (thread == 0) {
+
+		_done = true;
+		for (const std::vector<NodeId>& nodes : _region_active)
+			_done = _done && nodes.empty();
+
+		_do_global_relabel = false;
+		_work_since_global_relabel = 0;
+	}
+
+	_barrier.wait();
+}
+
+void
+ParallelMaxFlow::concatenate(std::vector<std::vector<NodeId>>& lists, std::vector<NodeId>& target) {
+
+	std::size_t size = 0;
+	for (const std::vector<NodeId>& list : lists)
+		size += list.size();
+
+	target.clear();
+	target.reserve(size);
+
+	for (std::vector<NodeId>& list : lists) {
+
+		target.insert(target.end(), list.begin(), list.end());
+		list.clear();
+	}
+}
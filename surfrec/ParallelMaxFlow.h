@@ -0,0 +1,203 @@
+#ifndef PYSURFREC_SURFREC_PARALLEL_MAX_FLOW_H__
+#define PYSURFREC_SURFREC_PARALLEL_MAX_FLOW_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/**
+ * A multi-threaded max-flow / min-cut solver. Implements a region-partitioned
+ * push-relabel algorithm: The nodes are split into regions of consecutive
+ * ids, and the regions are colored such that regions of the same color are
+ * not connected by arcs. In each round, the colors are processed one after
+ * the other. The regions of the current color are discharged in parallel,
+ * each by one thread with a sequential FIFO push-relabel algorithm, while
+ * the labels of all other regions stay fixed. Flow pushed into another
+ * region is collected in per-thread outboxes and added to the excess of the
+ * receiving nodes after all regions of the color are done. Distance labels
+ * are periodically recomputed with a parallel breadth-first search from the
+ * sink (global relabeling).
+ *
+ * Only the first phase of push-relabel is run, which is sufficient to find
+ * the minimal cut and the value of the maximal flow.
+ *
+ * The threads only meet at barriers between two colors and during the
+ * global relabeling. Graphs whose node ids are local (like the closure
+ * graphs of IlpSolver, which are built column by column) need few colors.
+ * With one thread, there is a single region and no synchronization.
+ *
+ * The interface is the same as the one of MaxFlow.
+ */
+class ParallelMaxFlow {
+
+public:
+
+	typedef std::size_t NodeId;
+
+	/**
+	 * Create a new max-flow graph with memory reserved for the given number of
+	 * nodes and (pairs of) edges, to be solved with the given number of
+	 * threads.
+	 */
+	ParallelMaxFlow(std::size_t num_nodes = 0, std::size_t num_edges = 0, int num_threads = 1);
+
+	/**
+	 * Add n nodes to the graph, return the index to the first one.
+	 */
+	NodeId add_nodes(std::size_t num_nodes);
+
+	/**
+	 * Add a directed edge i->j with capacity cap and the reverse edge j->i
+	 * with capacity rev_cap.
+	 */
+	void add_edge(NodeId i, NodeId j, double cap, double rev_cap);
+
+	/**
+	 * Add capacities to the edges from the source to node i and from node i
+	 * to the sink.
+	 */
+	void add_tweights(NodeId i, double cap_source, double cap_sink);
+
+	/**
+	 * Compute the maximal flow from source to sink. Returns the value of the
+	 * flow, which equals the costs of the minimal cut.
+	 */
+	double max_flow();
+
+	/**
+	 * After max_flow(), test whether node i is on the source side of the
+	 * minimal cut.
+	 */
+	bool in_source_segment(NodeId i) const { return _label[i] >= _infinite_label; }
+
+	/**
+	 * The number of nodes in the graph.
+	 */
+	std::size_t num_nodes() const { return _excess.size(); }
+
+private:
+
+	typedef std::size_t ArcId;
+
+	/**
+	 * A reusable barrier to synchronize the worker threads between the
+	 * phases of a pulse.
+	 */
+	class Barrier {
+
+	public:
+
+		Barrier(int num_threads) : _num_threads(num_threads), _waiting(0), _generation(0) {}
+
+		void wait();
+
+	private:
+
+		std::mutex _mutex;
+		std::condition_variable _condition;
+		int _num_threads;
+		int _waiting;
+		unsigned long _generation;
+	};
+
+	struct Edge {
+
+		NodeId i;
+		NodeId j;
+		double cap;
+		double rev_cap;
+	};
+
+	// convert the added edges into a compressed arc representation
+	void build_arcs();
+
+	// split the nodes into regions and color them, such that regions of the
+	// same color are not adjacent
+	void color_regions();
+
+	// the main loop, run by each thread
+	void work(int thread);
+
+	// discharge the active nodes of region r until there are none left
+	void discharge_region(std::size_t r, int thread);
+
+	// push the excess of node u (in region r) along admissible arcs, relabel
+	// it if excess remains, append activated nodes of the region to active
+	// and add the flow into the sink to flow, return the number of scanned
+	// arcs
+	std::size_t discharge(NodeId u, std::size_t r, std::vector<NodeId>& active, double& flow, int thread);
+
+	// add the flow in the outboxes to the excess of the receiving nodes
+	void empty_outboxes();
+
+	// recompute exact distance labels with a breadth-first search from the
+	// sink, set the active nodes
+	void global_relabel(int thread);
+
+	// the region of node i
+	std::size_t region(NodeId i) const { return i/_region_size; }
+
+	// the range of items of a list of the given size processed by a thread
+	std::size_t chunk_begin(std::size_t size, int thread) const { return size*thread/_num_threads; }
+	std::size_t chunk_end(std::size_t size, int thread) const { return size*(thread + 1)/_num_threads; }
+
+	// concatenate the per-thread lists into one
+	void concatenate(std::vector<std::vector<NodeId>>& lists, std::vector<NodeId>& target);
+
+	int _num_threads;
+
+	// the edges added so far, converted into arcs in max_flow()
+	std::vector<Edge> _edges;
+
+	// compressed arc representation: the outgoing arcs of node i are
+	// _first_arc[i],...,_first_arc[i+1]-1
+	std::vector<ArcId>  _first_arc;
+	std::vector<NodeId> _head;
+	std::vector<ArcId>  _sister;
+	std::vector<double> _r_cap;
+
+	// excess of each node and residual capacity of the edge to the sink
+	std::vector<double> _excess;
+	std::vector<double> _sink_cap;
+
+	// distance labels
+	std::vector<int> _label;
+	int _infinite_label;
+
+	// marks active nodes, or nodes visited by the global relabeling
+	std::vector<std::atomic<unsigned char>> _flags;
+
+	// the regions of consecutive node ids, their active nodes, and the
+	// regions of each color
+	std::size_t _region_size;
+	std::size_t _num_regions;
+	std::vector<std::vector<NodeId>> _region_active;
+	std::vector<std::vector<std::size_t>> _color_regions;
+
+	// the next region of the current color to be discharged by any thread
+	std::atomic<std::size_t> _next_region;
+
+	// flow pushed by each thread into nodes of other regions
+	std::vector<std::vector<std::pair<NodeId, double>>> _outboxes;
+
+	// the current frontier of the global relabeling
+	std::vector<NodeId> _frontier;
+	std::vector<std::vector<NodeId>> _thread_lists;
+
+	// per-thread flow into the sink and relabeling work
+	std::vector<double> _thread_flow;
+	std::vector<std::size_t> _thread_work;
+
+	Barrier _barrier;
+
+	// decisions of the first thread, shared with the others
+	bool _done;
+	bool _do_global_relabel;
+	std::size_t _work_since_global_relabel;
+
+	double _flow;
+};
+
+#endif // PYSURFREC_SURFREC_PARALLEL_MAX_FLOW_H__
@@ -0,0 +1,175 @@
+# make sure surfrec.so can be found by adjusting your PYTHONPATH
+#
+# Solves small random problems with all engines and checks that they find
+# the same minimal costs: MinCut with one and several threads, Ilp with both
+# formulations, with and without presolve, lazy constraints, and detection
+# of integral LPs, and DynamicProgramming on forests without separation
+# constraints. The problems use level ranges, convex edge penalties,
+# separation constraints, and infinite costs (anywhere in a column).
+
+import surfrec
+import random
+
+def column_costs(values):
+
+    costs = surfrec.ColumnCosts()
+    costs.extend(values)
+    return costs
+
+def random_problem(tree, penalties, separations, ranges, infinite):
+
+    num_nodes = random.randint(1, 8)
+    num_levels = random.randint(1, 4)
+
+    problem = {
+        'num_nodes': num_nodes,
+        'num_levels': num_levels,
+        'costs': [ [ random.uniform(-5, 5) for l in range(num_levels) ] for n in range(num_nodes) ],
+        'edges': [],
+        'penalties': [],
+        'separations': [],
+        'ranges': [] }
+
+    if infinite:
+        for n in range(num_nodes):
+            for l in range(num_levels):
+                if random.randint(0, 3) == 0:
+                    problem['costs'][n][l] = float('inf')
+
+    if penalties:
+        for i in range(2):
+            # non-decreasing and convex in the difference
+            slopes = sorted([ random.uniform(0, 3) for d in range(num_levels) ])
+            costs = [0]
+            for s in slopes:
+                costs.append(costs[-1] + s)
+            problem['penalties'].append(costs)
+
+    def penalty():
+        if penalties and random.randint(0, 2) > 0:
+            return random.randrange(len(problem['penalties']))
+        return None
+
+    if tree:
+        for v in range(1, num_nodes):
+            if random.randint(0, 4) > 0:
+                problem['edges'].append((random.randrange(v), v, random.randint(0, 2), penalty()))
+    else:
+        for i in range(random.randint(0, 2*num_nodes)):
+            u = random.randrange(num_nodes)
+            v = random.randrange(num_nodes)
+            if u != v:
+                problem['edges'].append((u, v, random.randint(0, 2), penalty()))
+
+    if separations and num_nodes > 1:
+        for i in range(random.randint(1, 2)):
+            lower, upper = random.sample(range(num_nodes), 2)
+            min_separation = random.randint(-1, 1)
+            problem['separations'].append((lower, upper, min_separation, min_separation + random.randint(0, 2)))
+
+    if ranges:
+        for n in range(num_nodes):
+            if random.randint(0, 1) > 0:
+                first = random.randrange(num_levels)
+                problem['ranges'].append((n, first, random.randint(first, num_levels - 1)))
+
+    return problem
+
+def create_solver(problem):
+
+    s = surfrec.IlpSolver(problem['num_nodes'], len(problem['edges']), problem['num_levels'], 1)
+    s.add_nodes(problem['num_nodes'])
+
+    penalties = [ s.add_penalty(column_costs(costs)) for costs in problem['penalties'] ]
+
+    for (u, v, max_gradient, penalty) in problem['edges']:
+        if penalty is None:
+            s.add_edge(u, v, max_gradient)
+        else:
+            s.add_edge(u, v, max_gradient, penalties[penalty])
+
+    for (lower, upper, min_separation, max_separation) in problem['separations']:
+        s.add_separation(lower, upper, min_separation, max_separation)
+
+    for (n, first, last) in problem['ranges']:
+        s.set_level_range(n, first, last)
+
+    for n in range(problem['num_nodes']):
+        s.set_level_costs(n, column_costs(problem['costs'][n]))
+
+    return s
+
+def has_infinite_interior(problem):
+
+    for costs in problem['costs']:
+        finite = [ l for l in range(len(costs)) if costs[l] != float('inf') ]
+        if finite and any(costs[l] == float('inf') for l in range(finite[0], finite[-1])):
+            return True
+    return False
+
+def solve(problem, parameters):
+
+    s = create_solver(problem)
+
+    p = surfrec.IlpSolverParameters()
+    for (name, value) in parameters.items():
+        setattr(p, name, value)
+
+    try:
+        return s.min_surface(p)
+    except RuntimeError:
+        # the problem is infeasible
+        return None
+
+def test(num_problems, tree, penalties, separations, ranges, infinite):
+
+    Ilp = surfrec.IlpSolverEngine.Ilp
+    MinCut = surfrec.IlpSolverEngine.MinCut
+    Heights = surfrec.IlpSolverFormulation.Heights
+
+    # the first one is the reference
+    engines = [
+        { 'engine': MinCut, 'num_threads': 1 },
+        { 'engine': MinCut, 'num_threads': 3 },
+        { 'engine': Ilp },
+        { 'engine': Ilp, 'presolve': False },
+        { 'engine': Ilp, 'lazy_constraints': True },
+        { 'engine': Ilp, 'detect_integral_lp': False },
+        { 'engine': Ilp, 'formulation': Heights } ]
+    if tree and not separations:
+        engines.append({ 'engine': surfrec.IlpSolverEngine.DynamicProgramming })
+
+    for i in range(num_problems):
+
+        problem = random_problem(tree, penalties, separations, ranges, infinite)
+
+        for parameters in engines:
+
+            # the Heights formulation does not support infinite costs between
+            # finite ones
+            if parameters.get('formulation') == Heights and has_infinite_interior(problem):
+                continue
+
+            value = solve(problem, parameters)
+            if parameters is engines[0]:
+                expected = value
+
+            if expected is None or value is None:
+                assert value is None and expected is None, \
+                    "problem %d: %s disagrees on feasibility" % (i, str(parameters))
+            else:
+                assert abs(value - expected) < 1e-6, \
+                    "problem %d: %s found %f instead of %f" % (i, str(parameters), value, expected)
+
+    print("%d problems (tree: %s, penalties: %s, separations: %s, ranges: %s, infinite: %s) ok" % (num_problems, tree, penalties, separations, ranges, infinite))
+
+if __name__ == "__main__":
+
+    random.seed(123)
+
+    for tree in [True, False]:
+        for penalties in [False, True]:
+            for separations in [False, True]:
+                for ranges in [False, True]:
+                    for infinite in [False, True]:
+                        test(100, tree, penalties, separations, ranges, infinite)
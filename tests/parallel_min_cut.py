@@ -0,0 +1,98 @@
+# make sure surfrec.so can be found by adjusting your PYTHONPATH
+#
+# Compares the parallel push-relabel max-flow (MinCut engine with more than
+# one thread) to the serial max-flow on random graphs, and measures the
+# runtime of both on a larger grid for increasing numbers of threads.
+
+import surfrec
+import random
+import multiprocessing
+from timeit import default_timer
+
+def random_solver(num_nodes, num_edges, num_levels):
+
+    s = surfrec.IlpSolver(num_nodes, num_edges, num_levels, 1)
+    s.add_nodes(num_nodes)
+
+    for i in range(num_edges):
+        u = random.randrange(num_nodes)
+        v = random.randrange(num_nodes)
+        if u != v:
+            s.add_edge(u, v, random.randrange(num_levels))
+
+    for n in range(num_nodes):
+        costs = surfrec.ColumnCosts(num_levels)
+        for l in range(num_levels):
+            costs[l] = random.uniform(-10, 10)
+        s.set_level_costs(n, costs)
+
+    return s
+
+def parameters(num_threads):
+
+    p = surfrec.IlpSolverParameters()
+    p.engine = surfrec.IlpSolverEngine.MinCut
+    p.num_threads = num_threads
+    # keep all levels in the flow graph
+    p.presolve = False
+    p.contract_zero_gradient_edges = False
+    return p
+
+def test_random_graphs(num_graphs):
+
+    for i in range(num_graphs):
+
+        num_nodes = random.randint(1, 30)
+        num_levels = random.randint(1, 8)
+        num_edges = random.randint(0, 3*num_nodes)
+
+        s = random_solver(num_nodes, num_edges, num_levels)
+
+        serial = s.min_surface(parameters(1))
+        serial_levels = list(s.levels())
+
+        for num_threads in [2, 3, 4]:
+
+            parallel = s.min_surface(parameters(num_threads))
+            parallel_levels = list(s.levels())
+
+            # with random real-valued costs, the minimal cut is unique
+            assert abs(parallel - serial) < 1e-6*max(1.0, abs(serial)), \
+                "graph %d, %d threads: %f != %f" % (i, num_threads, parallel, serial)
+            assert parallel_levels == serial_levels, \
+                "graph %d, %d threads: different levels" % (i, num_threads)
+
+    print("compared %d random graphs" % num_graphs)
+
+def benchmark(size, num_levels):
+
+    num_nodes = size*size
+    s = surfrec.IlpSolver(num_nodes, 2*num_nodes, num_levels, 1)
+    s.add_nodes(num_nodes)
+    s.add_grid_edges([size, size], 4, [1])
+
+    for n in range(num_nodes):
+        costs = surfrec.ColumnCosts(num_levels)
+        for l in range(num_levels):
+            costs[l] = random.random()
+        s.set_level_costs(n, costs)
+
+    num_threads = 1
+    serial = None
+    while num_threads <= multiprocessing.cpu_count():
+
+        start = default_timer()
+        s.min_surface(parameters(num_threads))
+        runtime = default_timer() - start
+
+        if serial is None:
+            serial = runtime
+
+        print("%dx%d grid, %d levels, %2d threads: %.3fs (speedup %.2f)" % (size, size, num_levels, num_threads, runtime, serial/runtime))
+        num_threads *= 2
+
+if __name__ == "__main__":
+
+    random.seed(42)
+    test_random_graphs(500)
+    benchmark(128, 16)
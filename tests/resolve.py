@@ -0,0 +1,123 @@
+# make sure surfrec.so can be found by adjusting your PYTHONPATH
+#
+# Changes random problems between solves (costs with update_level_costs() or
+# set_level_costs(), edges, separations, level ranges) and checks that
+# resolve() finds the same minimal costs as a fresh solver for the changed
+# problem.
+
+import surfrec
+import random
+
+def column_costs(values):
+
+    costs = surfrec.ColumnCosts()
+    costs.extend(values)
+    return costs
+
+def random_costs(num_levels):
+
+    return [ random.uniform(-5, 5) for l in range(num_levels) ]
+
+class Problem:
+
+    def __init__(self, num_nodes, num_levels):
+
+        self.num_nodes = num_nodes
+        self.num_levels = num_levels
+        self.costs = [ random_costs(num_levels) for n in range(num_nodes) ]
+        self.edges = []
+        self.separations = []
+        self.ranges = {}
+
+    def create_solver(self):
+
+        s = surfrec.IlpSolver(self.num_nodes, len(self.edges), self.num_levels, 1)
+        s.add_nodes(self.num_nodes)
+        for (u, v, g) in self.edges:
+            s.add_edge(u, v, g)
+        for (lower, upper, lo, hi) in self.separations:
+            s.add_separation(lower, upper, lo, hi)
+        for n in self.ranges:
+            s.set_level_range(n, self.ranges[n][0], self.ranges[n][1])
+        for n in range(self.num_nodes):
+            s.set_level_costs(n, column_costs(self.costs[n]))
+        return s
+
+def random_edge(problem):
+
+    u, v = random.sample(range(problem.num_nodes), 2)
+    return (u, v, random.randint(0, 2))
+
+def change(problem, s):
+
+    n = random.randrange(problem.num_nodes)
+    kind = random.choice(['update', 'update', 'set', 'edge', 'separation', 'range'])
+
+    if kind == 'update':
+        problem.costs[n] = random_costs(problem.num_levels)
+        s.update_level_costs(n, column_costs(problem.costs[n]))
+    elif kind == 'set':
+        problem.costs[n] = random_costs(problem.num_levels)
+        s.set_level_costs(n, column_costs(problem.costs[n]))
+    elif kind == 'edge':
+        edge = random_edge(problem)
+        problem.edges.append(edge)
+        s.add_edge(*edge)
+    elif kind == 'separation':
+        lower, upper = random.sample(range(problem.num_nodes), 2)
+        separation = (lower, upper, -1, 1)
+        problem.separations.append(separation)
+        s.add_separation(*separation)
+    else:
+        first = random.randrange(problem.num_levels)
+        problem.ranges[n] = (first, problem.num_levels - 1)
+        s.set_level_range(n, first, problem.num_levels - 1)
+
+    return kind
+
+def solve(f):
+
+    try:
+        return f()
+    except RuntimeError:
+        # the problem is infeasible
+        return None
+
+def test(engine, num_problems):
+
+    p = surfrec.IlpSolverParameters()
+    p.engine = engine
+
+    for i in range(num_problems):
+
+        problem = Problem(random.randint(2, 6), random.randint(1, 4))
+        for j in range(random.randint(0, 8)):
+            problem.edges.append(random_edge(problem))
+
+        s = problem.create_solver()
+        if solve(lambda: s.min_surface(p)) is None:
+            continue
+
+        for j in range(5):
+
+            kind = change(problem, s)
+
+            value = solve(lambda: s.resolve())
+            expected = solve(lambda: problem.create_solver().min_surface(p))
+
+            if value is None or expected is None:
+                assert value is None and expected is None, \
+                    "problem %d, change %d (%s): disagreement on feasibility" % (i, j, kind)
+                break
+
+            assert abs(value - expected) < 1e-6, \
+                "problem %d, change %d (%s): resolve() found %f instead of %f" % (i, j, kind, value, expected)
+
+    print("%s: %d problems ok" % (str(engine), num_problems))
+
+if __name__ == "__main__":
+
+    random.seed(42)
+
+    for engine in [surfrec.IlpSolverEngine.MinCut, surfrec.IlpSolverEngine.Ilp]:
+        test(engine, 200)